@@ -11,7 +11,11 @@
  * - GET /version - Returns current firmware version in JSON format
  * - POST /otw - Handles firmware update upload via binary file
  * - DHCP support for network configuration
- * - Progress monitoring during firmware update
+ * - Progress monitoring during firmware update (at most once per second)
+ * - Support for "Expect: 100-continue": oversized firmware is rejected before it is sent
+ * - SHA-256 verification of the received firmware (X-SHA256 or Content-Digest header)
+ * - Network reads overlapped with flash writes (double buffering)
+ * - In-memory cache of the rendered /version response
  * - Automatic restart after successful update
  * - Error handling and status reporting
  * - Serial debug output
@@ -30,6 +34,8 @@
  * - You can download Postman from https://www.postman.com/downloads/.
  * - To upload firmware with Postman, use the POST method and select "Body" -> "binary"
  *   and choose the compiled updated firmware. Then, upload the binary firmware file to the ESP32.
+ * - With curl, the hash of the firmware can be sent along so that a corrupted upload is never installed:
+ *   curl -H "X-SHA256: $(sha256sum firmware.bin | cut -d' ' -f1)" --data-binary @firmware.bin http://<ip>/otw
  *
  * @author Michel Galvão
  * @see https://github.com/MicSG-dev
@@ -56,6 +62,12 @@ const char *VERSION_FIRMWARE = "0.0.1"; // Defines the firmware version as a con
 
 bool shouldRestart = false;
 
+uint8_t cachePool[1024];                                     // Memory used to store the rendered responses (could also be allocated in PSRAM)
+ResponseCache responseCache(cachePool, sizeof(cachePool), 2); // Cache split into 2 entries of 512 bytes
+
+UpdateSink updateSink(U_FLASH);  // Writes the upload to the flash with the Update library
+UploadEngine upload(updateSink); // Receives the firmware and streams it to updateSink
+
 void setup()
 {
   Serial.begin(115200);
@@ -82,6 +94,11 @@ void setup()
   Serial.println(Ethernet.localIP());
 
   server.begin();
+
+  // Reports the progress of the firmware upload at most once per second
+  upload.onProgress([](size_t received, size_t total)
+                    { Serial.printf("Progress: %lu of %lu bytes received\r\n", (unsigned long)received, (unsigned long)total); },
+                    1000);
 }
 
 void loop()
@@ -101,162 +118,76 @@ void loop()
     IPAddress remoteClient = client.remoteIP();
     Serial.printf("\r\nConnected client: %u.%u.%u.%u\r\n", remoteClient[0], remoteClient[1], remoteClient[2], remoteClient[3]);
 
-    char currentLine[640] = "";  // Current line of the request. 640 is the maximum a line can have by default, where this is the result of the sum of Key (128) + Value (512) in Others Headers.
-    size_t currentLineIndex = 0; // Current line index
-
     AnalyserRequest request;
+    RequestReader reader(client, request); // Reads the request within the deadlines set with RequestReader::setTimeouts()
 
-    while (client.connected())
+    if (reader.read() == RequestReader::READY) // Request line and headers received in time
     {
-      if (client.available())
+      if (request.methodIs(MethodsHttp::GET)) // Check if the request method is GET
       {
-        char c = client.read();
-        Serial.write(c); // For debugging purposes, every request received is printed in the Serial Monitor
-
-        // Detect end of HTTP header (empty line)
-        if (c == '\n' && currentLineIndex == 0)
+        // Check if the URL is '/version'
+        if (request.urlIs("/version"))
         {
-          if (request.methodIs(MethodsHttp::GET)) // Check if the request method is GET
-          {
-            // Check if the URL is '/version'
-            if (request.urlIs("/version"))
-            {
-              Serial.println("URL '/version' detected");
-
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);                        // Set the response status code
-              response.send(ContentType::APPLICATION_JSON, "{\"version\":\"", false); // Send the response as JSON, without sending line breaks (false argument)
-              response.send(VERSION_FIRMWARE, false);                                 // Send the rest of the response without line breaks (false argument)
-              response.send("\"}");                                                   // Send the rest of the response without line breaks (false argument)
-            }
-            else
-            {
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
-              response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
-            }
-            break;
-          }
-          else if (request.methodIs(MethodsHttp::POST)) // Check if the request method is POST
-          {
-            if (request.urlIs("/otw"))
-            {
-              Serial.println("URL '/otw' detected");
-
-              if (request.getContentLength() > 0)
-              {
-                if (!Update.begin(request.getContentLength(), U_FLASH)) // Initiates the firmware update process with the specified content length and flash type (flash [U_FLASH] or file system [U_SPIFFS]).
-                {
-                  Serial.printf("Error starting OTW: %s\n", Update.errorString());
-
-                  BuildResponse response(client);
-                  response.begin(StatusCode::ServerError::_500_INTERNAL_SERVER_ERROR);
-                  response.send("Error starting OTW: ", false);
-                  response.send(Update.errorString());
-
-                  break;
-                }
-              }
-              else
-              {
-                Serial.println("Content-Length not found or invalid.");
-                BuildResponse response(client);
-                response.begin(StatusCode::ClientError::_400_BAD_REQUEST);
-                response.send(ContentType::TEXT_PLAIN, "Content-Length not found or invalid.");
-
-                break;
-              }
-
-              uint8_t buffer[512];
-              size_t totalWritten = 0;
-              while (client.available())
-              {
-                size_t bytesRead = client.read(buffer, sizeof(buffer));
-                if (Update.write(buffer, bytesRead) != bytesRead) // Writes the received data to the flash memory. If the number of bytes written does not match the number of bytes read, an error occurred.
-                {
-                  Serial.println("Error writing OTA data block");
-                  break;
-                }
-
-                totalWritten += bytesRead;
-                Serial.print("Progress: ");
-                Serial.print(totalWritten);
-                Serial.println(" bytes written");
-              }
-
-              if (Update.end()) // Finalizes the firmware update process. If the update ends successfully, the function returns true.
-              {
-                if (Update.isFinished()) // Checks if the firmware update process has finished successfully.
-                {
-                  Serial.println("OTW completed successfully! Scheduled for Restart");
-                  shouldRestart = true;
-
-                  BuildResponse response(client);
-                  response.begin(StatusCode::Successful::_200_OK);
-                  response.send(ContentType::TEXT_PLAIN, "OTW completed successfully! Scheduled for Restart");
-                }
-                else
-                {
-                  Serial.println("OTW was not completed correctly");
+          Serial.println("URL '/version' detected");
 
-                  BuildResponse response(client);
-                  response.begin(StatusCode::ServerError::_500_INTERNAL_SERVER_ERROR);
-                  response.send(ContentType::TEXT_PLAIN, "OTW was not completed correctly");
-                }
-              }
-              else
-              {
-                Serial.printf("Error completing OTW: %s\r\n", Update.errorString());
-
-                BuildResponse response(client);
-                response.begin(StatusCode::ServerError::_500_INTERNAL_SERVER_ERROR);
-                response.send(ContentType::TEXT_PLAIN, "Error completing OTW: ", false);
-                response.send(Update.errorString());
-              }
-            }
-            else
-            {
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
-              response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
-            }
-
-            break;
-          }
-          else
+          if (!responseCache.serve(client, request)) // On a cache hit, the stored response is sent with a single write
           {
-            Serial.println("Unknown method.");
-            BuildResponse response(client);
-            response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
-            response.send(ContentType::TEXT_PLAIN, "Method not allowed");
-            break;
+            ResponseCache::Recorder recorder(responseCache, client, request, 10000); // Records the response sent below and keeps it for 10 seconds
+
+            // Build the response
+            BuildResponse response(recorder);
+            response.begin(StatusCode::Successful::_200_OK);                        // Set the response status code
+            response.send(ContentType::APPLICATION_JSON, "{\"version\":\"", false); // Send the response as JSON, without sending line breaks (false argument)
+            response.send(VERSION_FIRMWARE, false);                                 // Send the rest of the response without line breaks (false argument)
+            response.send("\"}");                                                   // Send the rest of the response without line breaks (false argument)
           }
         }
-
-        // Process the HTTP header
-        if (c == '\n')
+        else
         {
-          currentLine[currentLineIndex] = '\0'; // Ends the string
-
-          request.analyzeHttpLine(currentLine); // Use "Header currentHeader = request.analyzeHttpLine..." to get the current Header
-
-          currentLineIndex = 0;
+          // Build the response
+          BuildResponse response(client);
+          response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
+          response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
         }
-        else if (c != '\r')
+      }
+      else if (request.methodIs(MethodsHttp::POST)) // Check if the request method is POST
+      {
+        if (request.urlIs("/otw"))
         {
-          if (currentLineIndex < sizeof(currentLine) - 1)
+          Serial.println("URL '/otw' detected");
+
+          // Checks Content-Length and the space in flash, answers "Expect: 100-continue", then receives the
+          // firmware while writing it to flash and verifies its SHA-256 (when an X-SHA256 or Content-Digest header is sent)
+          if (upload.receive(client, request) == UploadEngine::COMPLETED)
           {
-            currentLine[currentLineIndex++] = c;
+            Serial.println("OTW completed successfully! Scheduled for Restart");
+            shouldRestart = true;
+            responseCache.invalidate("/version"); // The cached version is no longer valid
+
+            BuildResponse response(client);
+            response.begin(StatusCode::Successful::_200_OK);
+            response.send(ContentType::TEXT_PLAIN, "OTW completed successfully! Scheduled for Restart");
           }
           else
           {
-            Serial.println("Error: CurrentLine array capacity exceeded!");
-            currentLineIndex = 0; // Reset the index to avoid future errors
+            Serial.printf("OTW failed: %s\r\n", upload.errorString());
+            upload.respond(client, request); // Sends the status code matching the error (411, 413, 422, ...)
           }
         }
+        else
+        {
+          // Build the response
+          BuildResponse response(client);
+          response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
+          response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
+        }
+      }
+      else
+      {
+        Serial.println("Unknown method.");
+        BuildResponse response(client);
+        response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
+        response.send(ContentType::TEXT_PLAIN, "Method not allowed");
       }
     }
 
@@ -0,0 +1,199 @@
+/**
+ * @file ServerSentEvents.ino
+ * @brief Example sketch demonstrating Server-Sent Events with the RequestsAndResponses library on ESP32
+ *
+ * This sketch implements a web server using the RequestsAndResponses library and EthernetLarge library.
+ * Browser tabs open '/events' with an EventSource and receive the telemetry published by the ESP32,
+ * without polling. Each event is formatted once and shared by all the open tabs.
+ *
+ * Features:
+ * - HTTP GET method handling
+ * - text/event-stream endpoint on '/events' (several tabs at the same time)
+ * - Resume of the stream after a reconnection (Last-Event-ID)
+ * - Telemetry published once per second
+ * - Page rendered from a PROGMEM template, with the current values in place of its placeholders
+ *
+ * Hardware Requirements:
+ * - ESP32 board
+ * - Ethernet W5500 module (CS pin on GPIO5)
+ *
+ * Required Libraries:
+ * - EthernetLarge (https://github.com/MicSG-dev/EthernetLarge)
+ * - RequestsAndResponses (https://github.com/MicSG-dev/RequestsAndResponses)
+ * - SPI (Built-in)
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include <SPI.h>
+#include <EthernetLarge.h>
+#include "RequestsAndResponses.h"
+
+// Network settings
+byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED}; // Fictitious MAC address
+IPAddress ip(192, 168, 0, 177);                    // Static IP
+EthernetServer server(80);                         // Server on port 80
+
+EthernetClient streamClients[EVENT_SOURCE_MAX_SUBSCRIBERS]; // Connections kept open for the event streams
+EventSource events;
+
+unsigned long lastPublish = 0;
+
+const char INDEX_HTML[] PROGMEM = R"=====(<!DOCTYPE html>
+<html>
+<body>
+  <h1>Free heap: <span id="heap">{{heap}}</span> bytes</h1>
+  <p>Up for {{uptime}} s</p>
+  <script>
+    const source = new EventSource('/events');
+    source.addEventListener('telemetry', (event) => document.getElementById('heap').textContent = JSON.parse(event.data).heap);
+  </script>
+</body>
+</html>
+)=====";
+
+// Placeholders of INDEX_HTML, in the order of the ids received by the resolver
+const char *const PAGE_FIELDS[] = {"heap", "uptime"};
+enum PageField
+{
+  FIELD_HEAP,
+  FIELD_UPTIME
+};
+
+PageTemplate indexPage(INDEX_HTML, PAGE_FIELDS, 2); // Scanned once, here
+
+// Returns true if the client is one of the open event streams
+bool isStreamClient(EthernetClient &client)
+{
+  for (size_t i = 0; i < EVENT_SOURCE_MAX_SUBSCRIBERS; i++)
+  {
+    if (streamClients[i] == client)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns a slot to keep the connection of a new event stream
+EthernetClient *freeStreamSlot()
+{
+  for (size_t i = 0; i < EVENT_SOURCE_MAX_SUBSCRIBERS; i++)
+  {
+    if (!streamClients[i].connected())
+    {
+      streamClients[i].stop(); // Releases the socket of the stream that ended before the slot is reused
+      return &streamClients[i];
+    }
+  }
+  return nullptr;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  while (!Serial)
+  {
+    ; // Wait for Serial to initialize
+  }
+
+  Serial.println("Example RequestsAndResponses ServerSentEvents");
+
+  Ethernet.init(5); // CS pin
+  if (Ethernet.begin(mac) == 0)
+  {
+    Serial.println("Failed to configure Ethernet using DHCP");
+    while (1)
+      ; // infinite loop
+  }
+
+  Serial.print("Server started. IP: ");
+  Serial.println(Ethernet.localIP());
+
+  server.begin();
+}
+
+void loop()
+{
+  // Publishes the telemetry once per second: the event is formatted once for all the tabs
+  if (millis() - lastPublish >= 1000)
+  {
+    lastPublish = millis();
+
+    char telemetry[48];
+    snprintf(telemetry, sizeof(telemetry), "{\"heap\":%u}", ESP.getFreeHeap());
+    events.publish(telemetry, "telemetry");
+  }
+
+  // Writes the pending events to each tab
+  events.loop();
+
+  EthernetClient client = server.available();
+
+  if (client && !isStreamClient(client))
+  {
+    IPAddress remoteClient = client.remoteIP();
+    Serial.printf("\r\nConnected client: %u.%u.%u.%u\r\n", remoteClient[0], remoteClient[1], remoteClient[2], remoteClient[3]);
+
+    bool keepOpen = false; // true when the connection became an event stream
+
+    AnalyserRequest request;
+    RequestReader reader(client, request); // Reads the request within the deadlines set with RequestReader::setTimeouts()
+
+    if (reader.read() == RequestReader::READY) // Request line and headers received in time
+    {
+      if (request.methodIs(MethodsHttp::GET) && request.urlIs("/events"))
+      {
+        EthernetClient *slot = freeStreamSlot();
+        if (slot != nullptr)
+        {
+          *slot = client; // The connection must outlive this loop iteration
+          keepOpen = events.subscribe(*slot, request);
+        }
+        else
+        {
+          events.subscribe(client, request); // Answers "503 Service Unavailable" when all the streams are in use
+        }
+      }
+      else if (request.methodIs(MethodsHttp::GET) && request.urlIs("/"))
+      {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_HTML, indexPage, [](uint8_t id, Print &output)
+                      {
+                        // Each value is printed straight into the response
+                        if (id == FIELD_HEAP)
+                        {
+                          output.print(ESP.getFreeHeap());
+                        }
+                        else if (id == FIELD_UPTIME)
+                        {
+                          output.print(millis() / 1000);
+                        } });
+      }
+      else
+      {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::ClientError::_404_NOT_FOUND);
+        response.send(ContentType::TEXT_PLAIN, "URL not found");
+      }
+    }
+
+    if (!keepOpen)
+    {
+      delay(1);
+      client.stop();
+      Serial.println("Client disconnected.");
+    }
+  }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file TelemetryClient.ino
+ * @brief Example sketch demonstrating the HTTP client of the RequestsAndResponses library on ESP32
+ *
+ * This sketch posts a telemetry reading to a collector on the local network every 5 seconds.
+ * The connection to the collector is kept open between posts (keep-alive), so only the first
+ * post pays for the TCP handshake.
+ *
+ * Features:
+ * - HTTP POST of JSON telemetry with HttpClient
+ * - Pool of keep-alive connections (HttpConnectionPool), closed after 30 seconds without use
+ * - Response status code, headers and body read incrementally (Content-Length or chunked)
+ *
+ * Hardware Requirements:
+ * - ESP32 board
+ * - Ethernet W5500 module (CS pin on GPIO5)
+ *
+ * Required Libraries:
+ * - EthernetLarge (https://github.com/MicSG-dev/EthernetLarge)
+ * - RequestsAndResponses (https://github.com/MicSG-dev/RequestsAndResponses)
+ * - SPI (Built-in)
+ *
+ * Tips:
+ * - Any HTTP server can play the collector, for example: python3 -m http.server 8080
+ *   (it answers 501 to POST requests, but the exchange can be followed in the Serial Monitor).
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include <SPI.h>
+#include <EthernetLarge.h>
+#include "RequestsAndResponses.h"
+
+// Network settings
+byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED}; // Fictitious MAC address
+
+// Collector settings
+const char *COLLECTOR_HOST = "192.168.0.10";
+const uint16_t COLLECTOR_PORT = 8080;
+
+EthernetClient connections[2];   // Sockets available to the pool
+HttpConnectionPool pool(30000); // Idle connections are closed after 30 seconds
+HttpClient http(pool);
+
+unsigned long lastPost = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  while (!Serial)
+  {
+    ; // Wait for Serial to initialize
+  }
+
+  Serial.println("Example RequestsAndResponses Telemetry Client");
+
+  Ethernet.init(5); // CS pin
+  if (Ethernet.begin(mac) == 0)
+  {
+    Serial.println("Failed to configure Ethernet using DHCP");
+    while (1)
+      ; // infinite loop
+  }
+
+  Serial.print("IP: ");
+  Serial.println(Ethernet.localIP());
+
+  for (EthernetClient &connection : connections)
+  {
+    pool.addClient(connection);
+  }
+
+  http.setTimeout(3000);
+
+  // Called with each piece of the response body, as it arrives
+  http.onBody([](const uint8_t *data, size_t size)
+              { Serial.write(data, size); });
+}
+
+void loop()
+{
+  // Closes the connections that have been idle for too long
+  pool.expire();
+
+  if (millis() - lastPost < 5000)
+  {
+    return;
+  }
+  lastPost = millis();
+
+  char telemetry[64];
+  snprintf(telemetry, sizeof(telemetry), "{\"uptime\":%lu,\"heap\":%u}", millis() / 1000, ESP.getFreeHeap());
+
+  http.addHeader("X-Device", "esp32-01"); // Extra headers apply to the next request only
+
+  unsigned long start = millis();
+  int status = http.post(COLLECTOR_HOST, COLLECTOR_PORT, "/telemetry", ContentType::APPLICATION_JSON, telemetry);
+  Serial.println();
+
+  if (status > 0)
+  {
+    Serial.printf("Collector answered %d in %lu ms (connections opened: %u, reused: %u)\r\n",
+                  status, millis() - start, pool.getOpened(), pool.getReused());
+  }
+  else
+  {
+    Serial.printf("Telemetry post failed: %d\r\n", status);
+  }
+}
@@ -3,14 +3,18 @@
  * @brief Example sketch demonstrating usage of RequestsAndResponses library for HTTP server implementation on ESP32
  *
  * This sketch implements a web server using the RequestsAndResponses library and EthernetLarge library.
- * It handles HTTP GET, POST, PUT and DELETE methods and demonstrates request parsing and response building.
+ * It handles HTTP GET, HEAD, POST, PUT and DELETE methods and demonstrates request parsing and response building.
  *
  * Features:
- * - HTTP method handling (GET, POST, PUT, DELETE)
- * - URL routing (/test, /status-led endpoints)
+ * - HTTP method handling (GET, HEAD, POST, PUT, DELETE)
+ * - URL routing (/test, /stats, /status-led, /settings endpoints)
  * - Request header parsing
  * - Parameter and cookie parsing
  * - Response building with status codes and headers
+ * - Per-client rate limiting (429 Too Many Requests) and load shedding when the W5500 runs out of sockets (503 Service Unavailable)
+ * - Deadlines for slow or silent clients (408 Request Timeout) and counters at /stats
+ * - Access log of the requests, written to Serial by a task of low priority
+ * - JSON body of POST /settings parsed as it is received, straight into variables
  *
  * Hardware Requirements:
  * - ESP32 board
@@ -38,6 +42,7 @@
 #include "Arduino.h"
 #include <SPI.h>
 #include <EthernetLarge.h>
+#include <utility/w5100.h>
 #include "RequestsAndResponses.h"
 
 // Network settings
@@ -45,6 +50,40 @@ byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED}; // Fictitious MAC address
 IPAddress ip(192, 168, 0, 177);                    // Static IP
 EthernetServer server(80);                         // Server on port 80
 
+// Settings received at POST /settings, e.g. {"name":"Kitchen","led":{"on":true,"brightness":80}}
+char deviceName[33] = "ESP32";
+bool ledOn = false;
+int ledBrightness = 100;
+
+RateLimiter limiter(10, 200); // Each client can burst 10 requests and earns a new one every 200 ms
+
+// Sockets of the W5500 that are closed, i.e. available for the next connection
+uint8_t freeSockets()
+{
+  uint8_t free = 0;
+  SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+  for (uint8_t i = 0; i < MAX_SOCK_NUM; i++)
+  {
+    if (W5100.readSnSR(i) == SnSR::CLOSED)
+    {
+      free++;
+    }
+  }
+  SPI.endTransaction();
+  return free;
+}
+
+// Routes named in the access log
+enum Route
+{
+  ROUTE_TEST,
+  ROUTE_STATS,
+  ROUTE_STATUS_LED,
+  ROUTE_SETTINGS
+};
+const char *const routes[] = {"/test", "/stats", "/status-led", "/settings"};
+AccessLog accessLog; // One line per request, written to Serial without holding up the responses
+
 void setup()
 {
   Serial.begin(115200);
@@ -57,6 +96,16 @@ void setup()
 
   Serial.println("Example RequestsAndResponses WebServer");
 
+  limiter.addRoute("/status-led", 2, 1000); // The '/status-led' route has its own, tighter budget: 2 requests, one more per second
+  limiter.setCapacityProbe(freeSockets, 1);  // "503 Service Unavailable" when no socket is left to listen for the next connection
+
+  // Deadlines (ms) for the request line, the headers, body inactivity, the whole request and a client that stops reading the response
+  ConnectionTimeouts timeouts = {3000, 5000, 5000, 20000, 5000};
+  RequestReader::setTimeouts(timeouts);
+
+  accessLog.setRoutes(routes, 4);
+  accessLog.beginTask(Serial); // The log is written to Serial by a task of low priority
+
   Ethernet.init(5); // CS pin
   if (Ethernet.begin(mac) == 0)
   {
@@ -78,179 +127,167 @@ void loop()
 
   if (client)
   {
-    IPAddress remoteClient = client.remoteIP();
-    Serial.printf("\r\nConnected client: %u.%u.%u.%u\r\n", remoteClient[0], remoteClient[1], remoteClient[2], remoteClient[3]);
+    if (!limiter.admit(client)) // Sends "503 Service Unavailable" when the server is out of sockets
+    {
+      client.stop();
+      return;
+    }
 
-    char currentLine[640] = "";  // Current line of the request. 640 is the maximum a line can have by default, where this is the result of the sum of Key (128) + Value (512) in Others Headers.
-    size_t currentLineIndex = 0; // Current line index
+    IPAddress remoteClient = client.remoteIP();
 
     AnalyserRequest request;
+    AccessLog::Recorder logged(accessLog, client, request, remoteClient); // Adds the record of the request to the log at the end of the scope
+    RequestReader reader(logged, request);                                // Reads the request within the deadlines set with RequestReader::setTimeouts()
 
     char fruit[50] = ""; // increase the array size as needed
 
-    while (client.connected())
+    // Checked right after the request line, before the headers are read
+    reader.onRequestLine([&](Client &client, AnalyserRequest &request)
+                         {
+                           if (!limiter.check(client, remoteClient, request)) // Sends "429 Too Many Requests" when the client has exhausted its budget
+                           {
+                             return false; // Logged with status 429
+                           }
+                           return true; });
+
+    // Called with each header that AnalyserRequest does not store itself
+    reader.onHeader([&](const Header &header)
+                    {
+                      if (strcmp(header.key, "Fruit") == 0)
+                      {
+                        strncpy(fruit, header.value, sizeof(fruit) - 1);
+                      } });
+
+    if (reader.read() == RequestReader::READY) // Request line and headers received in time
     {
-      if (client.available())
+      if (request.methodIs(MethodsHttp::GET) || request.methodIs(MethodsHttp::HEAD)) // Check if the request method is GET (or HEAD, which is answered like GET but without body)
       {
-        char c = client.read();
-        Serial.write(c); // For debugging purposes, every request received is printed in the Serial Monitor
-
-        // Detect end of HTTP header (empty line)
-        if (c == '\n' && currentLineIndex == 0)
+        // Check if the URL is '/test'
+        if (request.urlIs("/test"))
         {
-          if (request.methodIs(MethodsHttp::GET)) // Check if the request method is GET
-          {
-            Serial.println("GET method!");
-            Serial.print("URL: ");
-            Serial.println(request.getUrl());
-            Serial.print("Content-Length: ");
-            Serial.println(request.getContentLength());
-            Serial.print("Content-Type: ");
-            Serial.println(request.getContentType());
-
-            // Check if the URL is '/test'
-            if (request.urlIs("/test"))
-            {
-              Serial.println("URL '/test' detected");
-
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);                // Set the response status code
-              response.addHeader("Test", "Test value");                       // Add a custom header
-              response.send(ContentType::TEXT_PLAIN, "URL '/test' detected"); // Send the response with a content type and content
-
-              Serial.print("Parameters: ");
-              Serial.println(request.getParams());
-
-              // Check if the parameter 'name' exists
-              if (request.paramExists("name"))
-              {
-                Serial.print("Parameter 'name' exists: ");
-                Serial.println(request.getParam("name"));
-              }
-              else
-              {
-                Serial.println("Parameter 'name' does not exist");
-              }
-
-              Serial.print("All cookies: ");
-              Serial.println(request.getCookies());
-              Serial.print("Cookie 'Car': ");
-              Serial.println(request.getCookie("Car"));
-              Serial.print("Header 'Fruit': ");
-              Serial.println(fruit);
-            }
-            else
-            {
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
-              response.addHeader("Hello", "World!");                   // Add a custom header
-              response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
-            }
-            break;
-          }
-          else if (request.methodIs(MethodsHttp::POST)) // Check if the request method is POST
-          {
-            Serial.println("POST method!");
-            Serial.print("URL: ");
-            Serial.println(request.getUrl());
-            Serial.print("Content-Length: ");
-            Serial.println(request.getContentLength());
-            Serial.print("Content-Type: ");
-            Serial.println(request.getContentType());
-
-            if (request.urlIs("/status-led"))
-            {
-              Serial.println("URL '/status-led' detected");
-
-              while (client.available())
-              {
-                char c = client.read();
-                Serial.write(c);
-              }
-              Serial.println();
-
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);                            // Set the response status code
-              response.send(ContentType::TEXT_PLAIN, "LED status changed successfully!"); // Send the response with a content type and content
-            }
-            else
-            {
-              // Build the response
-              BuildResponse response(client);
-              response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
-              response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
-            }
-
-            break;
-          }
-          else if (request.methodIs(MethodsHttp::PUT))
-          {
-            Serial.println("PUT method!");
-            Serial.print("URL: ");
-            Serial.println(request.getUrl());
+          logged.setRoute(ROUTE_TEST);
 
-            BuildResponse response(client);
-            response.begin(StatusCode::Successful::_200_OK);
-            response.send(ContentType::TEXT_PLAIN, "PUT method detected");
-            break;
-          }
-          else if (request.methodIs(MethodsHttp::DELETE))
-          {
-            Serial.println("DELETE method!");
-            Serial.print("URL: ");
-            Serial.println(request.getUrl());
+          // What was parsed from the request is sent back in the response instead of being printed
+          // to Serial while the request is handled (the access log already records each request)
+          const char *name = request.getParam("name");
+          const char *car = request.getCookie("Car");
+          char text[256];
+          snprintf(text, sizeof(text), "URL '/test' detected\nParameters: %s\nParameter 'name': %s\nCookies: %s\nCookie 'Car': %s\nHeader 'Fruit': %s",
+                   request.getParams(), name != NULL ? name : "(none)", request.getCookies(), car != NULL ? car : "(none)", fruit);
 
-            BuildResponse response(client);
-            response.begin(StatusCode::Successful::_200_OK);
-            response.send(ContentType::TEXT_PLAIN, "DELETE method detected");
-            break;
-          }
-          else
-          {
-            Serial.println("Unknown method.");
-            BuildResponse response(client);
-            response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
-            response.send(ContentType::TEXT_PLAIN, "Method not allowed");
-            break;
-          }
+          // Build the response
+          BuildResponse response(logged, request);
+          response.begin(StatusCode::Successful::_200_OK); // Set the response status code
+          response.addHeader("Test", "Test value");        // Add a custom header
+          response.send(ContentType::TEXT_PLAIN, text);    // Send the response with a content type and content
         }
+        else if (request.urlIs("/stats"))
+        {
+          logged.setRoute(ROUTE_STATS);
+          // Counters of the connections that were closed because of a deadline or a bad request
+          ConnectionStats stats = RequestReader::getStats();
 
-        // Process the HTTP header
-        if (c == '\n')
+          char json[256];
+          snprintf(json, sizeof(json),
+                   "{\"requests\":%lu,\"requestLineTimeouts\":%lu,\"headerTimeouts\":%lu,\"bodyTimeouts\":%lu,"
+                   "\"totalTimeouts\":%lu,\"writeStalls\":%lu,\"closedEarly\":%lu,\"oversized\":%lu,\"malformed\":%lu,\"rejected\":%lu}",
+                   (unsigned long)stats.requests, (unsigned long)stats.requestLineTimeouts, (unsigned long)stats.headerTimeouts,
+                   (unsigned long)stats.bodyTimeouts, (unsigned long)stats.totalTimeouts, (unsigned long)stats.writeStalls,
+                   (unsigned long)stats.closedEarly, (unsigned long)stats.oversized, (unsigned long)stats.malformed,
+                   (unsigned long)stats.rejected);
+
+          BuildResponse response(logged, request);
+          response.begin(StatusCode::Successful::_200_OK);
+          response.send(ContentType::APPLICATION_JSON, json);
+        }
+        else
         {
-          currentLine[currentLineIndex] = '\0'; // Ends the string
+          // Build the response
+          BuildResponse response(logged, request);
+          response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
+          response.addHeader("Hello", "World!");                   // Add a custom header
+          response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
+        }
+      }
+      else if (request.methodIs(MethodsHttp::POST)) // Check if the request method is POST
+      {
+        if (request.urlIs("/status-led"))
+        {
+          logged.setRoute(ROUTE_STATUS_LED);
 
-          Header currentHeader = request.analyzeHttpLine(currentLine);
-          if (currentHeader.key != NULL)
+          // The body is read within the body deadlines: a client that stops sending gets "408 Request Timeout"
+          uint8_t body[64];
+          while (reader.readBody(body, sizeof(body)) > 0)
           {
-            if (strcmp(currentHeader.key, "Fruit") == 0)
-            {
-              strncpy(fruit, currentHeader.value, sizeof(fruit));
-            }
+            ; // The content of the body is not used by this example
           }
 
-          currentLineIndex = 0;
+          if (reader.getResult() == RequestReader::READY) // Otherwise the reader has already answered (e.g. 408) or the client left
+          {
+            // Build the response
+            BuildResponse response(logged, request);
+            response.begin(StatusCode::Successful::_200_OK);                            // Set the response status code
+            response.send(ContentType::TEXT_PLAIN, "LED status changed successfully!"); // Send the response with a content type and content
+          }
         }
-        else if (c != '\r')
+        else if (request.urlIs("/settings"))
         {
-          if (currentLineIndex < sizeof(currentLine) - 1)
+          logged.setRoute(ROUTE_SETTINGS);
+
+          // The body is parsed while it is received, whatever its size, into the variables bound to its paths
+          JsonParser parser;
+          parser.bind("name", deviceName, sizeof(deviceName));
+          parser.bind("led.on", ledOn);
+          parser.bind("led.brightness", ledBrightness);
+
+          JsonParser::Status status = parser.parseBody(reader);
+          if (status == JsonParser::DONE)
           {
-            currentLine[currentLineIndex++] = c;
+            char json[96];
+            snprintf(json, sizeof(json), "{\"name\":\"%s\",\"led\":{\"on\":%s,\"brightness\":%d}}",
+                     deviceName, ledOn ? "true" : "false", ledBrightness);
+
+            BuildResponse response(logged, request);
+            response.begin(StatusCode::Successful::_200_OK);
+            response.send(ContentType::APPLICATION_JSON, json);
           }
-          else
+          else if (status != JsonParser::BODY_STOPPED) // A body that stopped coming was already answered by the reader (e.g. 408)
           {
-            Serial.println("Error: CurrentLine array capacity exceeded!");
-            currentLineIndex = 0; // Reset the index to avoid future errors
+            BuildResponse response(logged, request);
+            response.begin(StatusCode::ClientError::_400_BAD_REQUEST);
+            response.send(ContentType::TEXT_PLAIN, "Invalid JSON");
           }
         }
+        else
+        {
+          // Build the response
+          BuildResponse response(logged, request);
+          response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
+          response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
+        }
+      }
+      else if (request.methodIs(MethodsHttp::PUT))
+      {
+        BuildResponse response(logged, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_PLAIN, "PUT method detected");
+      }
+      else if (request.methodIs(MethodsHttp::DELETE))
+      {
+        BuildResponse response(logged, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_PLAIN, "DELETE method detected");
+      }
+      else
+      {
+        BuildResponse response(logged, request);
+        response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
+        response.send(ContentType::TEXT_PLAIN, "Method not allowed");
       }
     }
 
     delay(1);
+    logged.commit(); // Duration up to the close of the connection
     client.stop();
-    Serial.println("Client disconnected.");
   }
 }
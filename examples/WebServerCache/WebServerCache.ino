@@ -11,6 +11,7 @@
  * - Client-side caching implementation
  * - Response building with status codes and cache headers
  * - Static file serving with caching
+ * - On-the-fly gzip compression of the HTML page (when the browser accepts it)
  *
  * Hardware Requirements:
  * - ESP32 board
@@ -44,6 +45,8 @@ EthernetServer server(80);                         // Server on port 80
 
 const char *VERSION_FIRMWARE = "0.0.1"; // Defines the firmware version as a constant string.
 
+GzipEncoder gzip; // Compressor shared by the responses (about 3.5 KB of RAM)
+
 void setup()
 {
   Serial.begin(115200);
@@ -80,134 +83,99 @@ void loop()
     IPAddress remoteClient = client.remoteIP();
     Serial.printf("\r\nConnected client: %u.%u.%u.%u\r\n", remoteClient[0], remoteClient[1], remoteClient[2], remoteClient[3]);
 
-    char currentLine[640] = "";  // Current line of the request. 640 is the maximum a line can have by default, where this is the result of the sum of Key (128) + Value (512) in Others Headers.
-    size_t currentLineIndex = 0; // Current line index
-
     AnalyserRequest request;
+    RequestReader reader(client, request); // Reads the request within the deadlines set with RequestReader::setTimeouts()
 
-    while (client.connected())
+    if (reader.read() == RequestReader::READY) // Request line and headers received in time
     {
-      if (client.available())
+      if (request.methodIs(MethodsHttp::GET)) // Check if the request method is GET
       {
-        char c = client.read();
-        Serial.write(c); // For debugging purposes, every request received is printed in the Serial Monitor
-
-        // Detect end of HTTP header (empty line)
-        if (c == '\n' && currentLineIndex == 0)
+        Serial.println("GET method!");
+        Serial.print("URL: ");
+        Serial.println(request.getUrl());
+        Serial.print("Content-Length: ");
+        Serial.println(request.getContentLength());
+        Serial.print("Content-Type: ");
+        Serial.println(request.getContentType());
+
+        // Check if the URL is '/test'
+        if (request.urlIs("/"))
         {
-          if (request.methodIs(MethodsHttp::GET)) // Check if the request method is GET
-          {
-            Serial.println("GET method!");
-            Serial.print("URL: ");
-            Serial.println(request.getUrl());
-            Serial.print("Content-Length: ");
-            Serial.println(request.getContentLength());
-            Serial.print("Content-Type: ");
-            Serial.println(request.getContentType());
-
-            // Check if the URL is '/test'
-            if (request.urlIs("/"))
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::Redirection::_302_FOUND); // Set the HTTP status code to 302 Found, indicating that the requested resource resides temporarily under a different URI
-              response.addHeader("Location", "/index.html");       // Add a Location header to specify the new URI where the requested resource can be found
-              response.send();                                     // Send the HTTP response to the client
-            }
-            else if (request.urlIs("/index.html"))
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);                           // Set the response status code
-              response.addHeader("Cache-Control", "public, max-age=2592000, immutable"); // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
-              response.addHeader("ETag", VERSION_FIRMWARE);                              // Set ETag header using firmware version to enable client-side caching validation.
-                                                                                         //  When firmware version changes, clients will receive updated content since ETag won't match
-                                                                                         //
-              response.addHeader("Pragma", "cache");                                     // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
-                                                                                         //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
-                                                                                         //
-              response.send(ContentType::TEXT_HTML, INDEX_HTML, strlen_P(INDEX_HTML));   // Send the response with a content type, content and size of content
-            }
-            else if (request.urlIs("/assets/bootstrap/css/bootstrap.min.css"))
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);
-              response.addHeader("Cache-Control", "public, max-age=2592000, immutable");            // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
-              response.addHeader("ETag", VERSION_FIRMWARE);                                         // Set ETag header using firmware version to enable client-side caching validation.
-                                                                                                    //  When firmware version changes, clients will receive updated content since ETag won't match
-                                                                                                    //
-              response.addHeader("Pragma", "cache");                                                // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
-                                                                                                    //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
-                                                                                                    //
-              response.send(ContentType::TEXT_CSS, BOOTSTRAP_MIN_CSS, strlen_P(BOOTSTRAP_MIN_CSS)); // Send the response with a content type and content
-            }
-            else if (request.urlIs("/assets/bootstrap/js/bootstrap.min.js"))
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);
-              response.addHeader("Cache-Control", "public, max-age=2592000, immutable");                 // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
-              response.addHeader("ETag", VERSION_FIRMWARE);                                              // Set ETag header using firmware version to enable client-side caching validation.
-                                                                                                         //  When firmware version changes, clients will receive updated content since ETag won't match
-                                                                                                         //
-              response.addHeader("Pragma", "cache");                                                     // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
-                                                                                                         //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
-                                                                                                         //
-              response.send(ContentType::TEXT_JAVASCRIPT, BOOTSTRAP_MIN_JS, strlen_P(BOOTSTRAP_MIN_JS)); // Send the response with a content type and content
-            }
-            else if (request.urlIs("/assets/js/script.js"))
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);
-              response.addHeader("Cache-Control", "public, max-age=2592000, immutable");   // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
-              response.addHeader("ETag", VERSION_FIRMWARE);                                // Set ETag header using firmware version to enable client-side caching validation.
-              response.addHeader("Pragma", "cache");                                       // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
-                                                                                           //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
-                                                                                           //
-              response.send(ContentType::TEXT_JAVASCRIPT, SCRIPT_JS, strlen_P(SCRIPT_JS)); // Send the response with a content type and content
-            }
-            else if (request.urlIs("/version"))
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::Successful::_200_OK);          // Set the response status code
-              response.send(ContentType::TEXT_PLAIN, VERSION_FIRMWARE); // Send the response with a content type and content
-            }
-            else
-            {
-              BuildResponse response(client);
-              response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
-              response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
-            }
-            break;
-          }
-          else
-          {
-            Serial.println("Unknown method.");
-            BuildResponse response(client);
-            response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
-            response.send(ContentType::TEXT_PLAIN, "Method not allowed");
-            break;
-          }
+          BuildResponse response(client);
+          response.begin(StatusCode::Redirection::_302_FOUND); // Set the HTTP status code to 302 Found, indicating that the requested resource resides temporarily under a different URI
+          response.addHeader("Location", "/index.html");       // Add a Location header to specify the new URI where the requested resource can be found
+          response.send();                                     // Send the HTTP response to the client
         }
-
-        // Process the HTTP header
-        if (c == '\n')
+        else if (request.urlIs("/index.html"))
         {
-          currentLine[currentLineIndex] = '\0'; // Ends the string
-
-          request.analyzeHttpLine(currentLine); // Use "Header currentHeader = request.analyzeHttpLine..." to get the current Header
-
-          currentLineIndex = 0;
+          BuildResponse response(client);
+          response.begin(StatusCode::Successful::_200_OK);                           // Set the response status code
+          response.enableCompression(gzip, request);                                 // Compress the page on the fly if the browser accepts gzip
+          response.addHeader("Cache-Control", "public, max-age=2592000, immutable"); // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
+          response.addHeader("ETag", VERSION_FIRMWARE);                              // Set ETag header using firmware version to enable client-side caching validation.
+                                                                                     //  When firmware version changes, clients will receive updated content since ETag won't match
+                                                                                     //
+          response.addHeader("Pragma", "cache");                                     // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
+                                                                                     //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
+                                                                                     //
+          response.send(ContentType::TEXT_HTML, INDEX_HTML, strlen_P(INDEX_HTML));   // Send the response with a content type, content and size of content
+        }
+        else if (request.urlIs("/assets/bootstrap/css/bootstrap.min.css"))
+        {
+          BuildResponse response(client);
+          response.begin(StatusCode::Successful::_200_OK);
+          response.addHeader("Cache-Control", "public, max-age=2592000, immutable");            // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
+          response.addHeader("ETag", VERSION_FIRMWARE);                                         // Set ETag header using firmware version to enable client-side caching validation.
+                                                                                                //  When firmware version changes, clients will receive updated content since ETag won't match
+                                                                                                //
+          response.addHeader("Pragma", "cache");                                                // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
+                                                                                                //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
+                                                                                                //
+          response.send(ContentType::TEXT_CSS, BOOTSTRAP_MIN_CSS, strlen_P(BOOTSTRAP_MIN_CSS)); // Send the response with a content type and content
         }
-        else if (c != '\r')
+        else if (request.urlIs("/assets/bootstrap/js/bootstrap.min.js"))
         {
-          if (currentLineIndex < sizeof(currentLine) - 1)
-          {
-            currentLine[currentLineIndex++] = c;
-          }
-          else
-          {
-            Serial.println("Error: CurrentLine array capacity exceeded!");
-            currentLineIndex = 0; // Reset the index to avoid future errors
-          }
+          BuildResponse response(client);
+          response.begin(StatusCode::Successful::_200_OK);
+          response.addHeader("Cache-Control", "public, max-age=2592000, immutable");                 // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
+          response.addHeader("ETag", VERSION_FIRMWARE);                                              // Set ETag header using firmware version to enable client-side caching validation.
+                                                                                                     //  When firmware version changes, clients will receive updated content since ETag won't match
+                                                                                                     //
+          response.addHeader("Pragma", "cache");                                                     // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
+                                                                                                     //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
+                                                                                                     //
+          response.send(ContentType::TEXT_JAVASCRIPT, BOOTSTRAP_MIN_JS, strlen_P(BOOTSTRAP_MIN_JS)); // Send the response with a content type and content
         }
+        else if (request.urlIs("/assets/js/script.js"))
+        {
+          BuildResponse response(client);
+          response.begin(StatusCode::Successful::_200_OK);
+          response.addHeader("Cache-Control", "public, max-age=2592000, immutable");   // Set Cache-Control header to allow caching for ~30 days and mark response as immutable since static assets won't change
+          response.addHeader("ETag", VERSION_FIRMWARE);                                // Set ETag header using firmware version to enable client-side caching validation.
+          response.addHeader("Pragma", "cache");                                       // Set Pragma header to "cache" for HTTP/1.0 backwards compatibility
+                                                                                       //  Used in conjunction with Cache-Control for older clients that don't support HTTP/1.1
+                                                                                       //
+          response.send(ContentType::TEXT_JAVASCRIPT, SCRIPT_JS, strlen_P(SCRIPT_JS)); // Send the response with a content type and content
+        }
+        else if (request.urlIs("/version"))
+        {
+          BuildResponse response(client);
+          response.begin(StatusCode::Successful::_200_OK);          // Set the response status code
+          response.send(ContentType::TEXT_PLAIN, VERSION_FIRMWARE); // Send the response with a content type and content
+        }
+        else
+        {
+          BuildResponse response(client);
+          response.begin(StatusCode::ClientError::_404_NOT_FOUND); // Set the response status code
+          response.send(ContentType::TEXT_PLAIN, "URL not found"); // Send the response with a content type and content
+        }
+      }
+      else
+      {
+        Serial.println("Unknown method.");
+        BuildResponse response(client);
+        response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
+        response.send(ContentType::TEXT_PLAIN, "Method not allowed");
       }
     }
 
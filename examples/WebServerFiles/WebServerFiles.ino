@@ -0,0 +1,185 @@
+/**
+ * @file WebServerFiles.ino
+ * @brief Example sketch demonstrating a file server with a RAM cache, using the RequestsAndResponses library on ESP32
+ *
+ * This sketch implements a web server using the RequestsAndResponses library and EthernetLarge library.
+ * The files of LittleFS are served by URL; the small files requested most often are kept in a
+ * FileCache, so they are sent from memory instead of being read from flash on every request.
+ *
+ * Features:
+ * - HTTP GET and HEAD method handling
+ * - Files of LittleFS served by URL ('/' is '/index.html')
+ * - RAM cache of the small files, with Content-Length and ETag headers
+ * - POST '/config.json' rewrites the file and invalidates its cached copy
+ * - Cache hits and misses at '/cache'
+ *
+ * Hardware Requirements:
+ * - ESP32 board (with PSRAM, the pool of the cache can be allocated with ps_malloc())
+ * - Ethernet W5500 module (CS pin on GPIO5)
+ *
+ * Required Libraries:
+ * - EthernetLarge (https://github.com/MicSG-dev/EthernetLarge)
+ * - RequestsAndResponses (https://github.com/MicSG-dev/RequestsAndResponses)
+ * - LittleFS (Built-in)
+ * - SPI (Built-in)
+ *
+ * Tips:
+ * - Upload the files (e.g. index.html, style.css, config.json) to LittleFS with the
+ *   "LittleFS Data Upload" tool of the Arduino IDE.
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include <SPI.h>
+#include <EthernetLarge.h>
+#include <LittleFS.h>
+#include "RequestsAndResponses.h"
+
+// Network settings
+byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED}; // Fictitious MAC address
+IPAddress ip(192, 168, 0, 177);                    // Static IP
+EthernetServer server(80);                         // Server on port 80
+
+uint8_t cachePool[32 * 1024];                                // Memory of the cache
+FileCache fileCache(cachePool, sizeof(cachePool), 8 * 1024); // Only files up to 8 KB are cached
+
+// Content type of a file, from its extension
+const char *contentTypeOf(const char *path)
+{
+  const char *extension = strrchr(path, '.');
+  if (extension == nullptr)
+  {
+    return ContentType::TEXT_PLAIN;
+  }
+  if (strcmp(extension, ".html") == 0)
+  {
+    return ContentType::TEXT_HTML;
+  }
+  if (strcmp(extension, ".css") == 0)
+  {
+    return ContentType::TEXT_CSS;
+  }
+  if (strcmp(extension, ".js") == 0)
+  {
+    return ContentType::TEXT_JAVASCRIPT;
+  }
+  if (strcmp(extension, ".json") == 0)
+  {
+    return ContentType::APPLICATION_JSON;
+  }
+  return ContentType::TEXT_PLAIN;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  while (!Serial)
+  {
+    ; // Wait for Serial to initialize
+  }
+
+  Serial.println("Example RequestsAndResponses WebServerFiles");
+
+  if (!LittleFS.begin(true))
+  {
+    Serial.println("Failed to mount LittleFS");
+    while (1)
+      ; // infinite loop
+  }
+
+  Ethernet.init(5); // CS pin
+  if (Ethernet.begin(mac) == 0)
+  {
+    Serial.println("Failed to configure Ethernet using DHCP");
+    while (1)
+      ; // infinite loop
+  }
+
+  Serial.print("Server started. IP: ");
+  Serial.println(Ethernet.localIP());
+
+  server.begin();
+}
+
+void loop()
+{
+  EthernetClient client = server.available();
+
+  if (client)
+  {
+    IPAddress remoteClient = client.remoteIP();
+    Serial.printf("\r\nConnected client: %u.%u.%u.%u\r\n", remoteClient[0], remoteClient[1], remoteClient[2], remoteClient[3]);
+
+    AnalyserRequest request;
+    RequestReader reader(client, request); // Reads the request within the deadlines set with RequestReader::setTimeouts()
+
+    if (reader.read() == RequestReader::READY) // Request line and headers received in time
+    {
+      if ((request.methodIs(MethodsHttp::GET) || request.methodIs(MethodsHttp::HEAD)) && request.urlIs("/cache"))
+      {
+        char json[64];
+        snprintf(json, sizeof(json), "{\"hits\":%u,\"misses\":%u,\"bytes\":%u}",
+                 (unsigned)fileCache.getHits(), (unsigned)fileCache.getMisses(), (unsigned)fileCache.getUsed());
+
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::APPLICATION_JSON, json);
+      }
+      else if (request.methodIs(MethodsHttp::GET) || request.methodIs(MethodsHttp::HEAD))
+      {
+        const char *path = request.urlIs("/") ? "/index.html" : request.getUrl();
+
+        BuildResponse response(client, request);
+        if (LittleFS.exists(path))
+        {
+          response.begin(StatusCode::Successful::_200_OK);
+          response.send(contentTypeOf(path), fileCache, LittleFS, path); // From memory when the file is in the cache
+        }
+        else
+        {
+          response.begin(StatusCode::ClientError::_404_NOT_FOUND);
+          response.send(ContentType::TEXT_PLAIN, "URL not found");
+        }
+      }
+      else if (request.methodIs(MethodsHttp::POST) && request.urlIs("/config.json"))
+      {
+        File file = LittleFS.open("/config.json", "w");
+        uint8_t body[64];
+        size_t length;
+        while ((length = reader.readBody(body, sizeof(body))) > 0)
+        {
+          file.write(body, length);
+        }
+        file.close();
+        fileCache.invalidate("/config.json"); // The next request reads the new content
+
+        if (reader.getResult() == RequestReader::READY) // Otherwise the reader has already answered (e.g. 408) or the client left
+        {
+          BuildResponse response(client, request);
+          response.begin(StatusCode::Successful::_200_OK);
+          response.send(ContentType::TEXT_PLAIN, "Configuration saved");
+        }
+      }
+      else
+      {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
+        response.send(ContentType::TEXT_PLAIN, "Method not allowed");
+      }
+    }
+
+    delay(1);
+    client.stop();
+    Serial.println("Client disconnected.");
+  }
+}
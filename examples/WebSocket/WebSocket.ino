@@ -0,0 +1,175 @@
+/**
+ * @file WebSocket.ino
+ * @brief Example sketch demonstrating a WebSocket server with the RequestsAndResponses library on ESP32
+ *
+ * This sketch implements a web server using the RequestsAndResponses library and EthernetLarge library.
+ * The page served at '/' opens a WebSocket to '/ws', and the ESP32 pushes the uptime to it every
+ * second instead of having the browser poll a REST endpoint.
+ *
+ * Features:
+ * - HTTP GET method handling
+ * - WebSocket handshake (101 Switching Protocols) on '/ws'
+ * - Push of live data from the ESP32 to the browser
+ * - Echo of the text messages received from the browser
+ *
+ * Hardware Requirements:
+ * - ESP32 board
+ * - Ethernet W5500 module (CS pin on GPIO5)
+ *
+ * Required Libraries:
+ * - EthernetLarge (https://github.com/MicSG-dev/EthernetLarge)
+ * - RequestsAndResponses (https://github.com/MicSG-dev/RequestsAndResponses)
+ * - SPI (Built-in)
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include <SPI.h>
+#include <EthernetLarge.h>
+#include "RequestsAndResponses.h"
+
+// Network settings
+byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED}; // Fictitious MAC address
+IPAddress ip(192, 168, 0, 177);                    // Static IP
+EthernetServer server(80);                         // Server on port 80
+
+EthernetClient webSocketClient; // Connection kept open after the upgrade
+WebSocket webSocket;
+
+unsigned long lastPush = 0;
+bool echoing = false; // true while the pieces of a message are being echoed
+
+const char INDEX_HTML[] PROGMEM = R"=====(<!DOCTYPE html>
+<html>
+<body>
+  <h1>Uptime: <span id="uptime">-</span> s</h1>
+  <script>
+    const socket = new WebSocket('ws://' + location.host + '/ws');
+    socket.onmessage = (event) => document.getElementById('uptime').textContent = event.data;
+  </script>
+</body>
+</html>
+)=====";
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  while (!Serial)
+  {
+    ; // Wait for Serial to initialize
+  }
+
+  Serial.println("Example RequestsAndResponses WebSocket");
+
+  Ethernet.init(5); // CS pin
+  if (Ethernet.begin(mac) == 0)
+  {
+    Serial.println("Failed to configure Ethernet using DHCP");
+    while (1)
+      ; // infinite loop
+  }
+
+  Serial.print("Server started. IP: ");
+  Serial.println(Ethernet.localIP());
+
+  server.begin();
+
+  // Called for every piece of message received from the browser
+  webSocket.onMessage([](WebSocket &socket, uint8_t opcode, const uint8_t *data, size_t size, bool final)
+                      {
+                        if (opcode == WebSocket::TEXT)
+                        {
+                          Serial.write(data, size);
+                          if (final)
+                          {
+                            Serial.println();
+                          }
+                          // Echo the message back as one message: the pieces (cut at the size of the buffer or at the
+                          // fragments of the browser) are sent as fragments, so messages and UTF-8 sequences stay whole
+                          socket.send(echoing ? WebSocket::CONTINUATION : WebSocket::TEXT, data, size, final);
+                          echoing = !final;
+                        }
+                        else if (opcode == WebSocket::CLOSE)
+                        {
+                          Serial.println("WebSocket closed by the browser");
+                        } });
+}
+
+void loop()
+{
+  // Reads the frames sent by the browser (pings are answered automatically)
+  webSocket.loop();
+
+  // Pushes the uptime once per second (not in the middle of an echoed message, whose fragments cannot be interleaved)
+  if (webSocket.connected() && !echoing && millis() - lastPush >= 1000)
+  {
+    lastPush = millis();
+
+    char uptime[16];
+    snprintf(uptime, sizeof(uptime), "%lu", millis() / 1000);
+    webSocket.sendText(uptime);
+  }
+
+  EthernetClient client = server.available();
+
+  if (client && client != webSocketClient)
+  {
+    IPAddress remoteClient = client.remoteIP();
+    Serial.printf("\r\nConnected client: %u.%u.%u.%u\r\n", remoteClient[0], remoteClient[1], remoteClient[2], remoteClient[3]);
+
+    bool keepOpen = false; // true when the connection was upgraded to WebSocket
+
+    AnalyserRequest request;
+    RequestReader reader(client, request); // Reads the request within the deadlines set with RequestReader::setTimeouts()
+
+    if (reader.read() == RequestReader::READY) // Request line and headers received in time
+    {
+      if (request.methodIs(MethodsHttp::GET) && request.urlIs("/ws"))
+      {
+        if (WebSocket::isUpgrade(request))
+        {
+          webSocket.close();        // Only one WebSocket at a time in this example
+          webSocketClient = client; // The connection must outlive this loop iteration
+          echoing = false;
+          keepOpen = webSocket.accept(webSocketClient, request);
+          Serial.println(keepOpen ? "WebSocket opened" : "WebSocket handshake refused");
+        }
+        else
+        {
+          BuildResponse response(client, request);
+          response.begin(StatusCode::ClientError::_400_BAD_REQUEST);
+          response.send(ContentType::TEXT_PLAIN, "WebSocket upgrade expected");
+        }
+      }
+      else if (request.methodIs(MethodsHttp::GET) && request.urlIs("/"))
+      {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_HTML, INDEX_HTML, strlen_P(INDEX_HTML));
+      }
+      else
+      {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::ClientError::_404_NOT_FOUND);
+        response.send(ContentType::TEXT_PLAIN, "URL not found");
+      }
+    }
+
+    if (!keepOpen)
+    {
+      delay(1);
+      client.stop();
+      Serial.println("Client disconnected.");
+    }
+  }
+}
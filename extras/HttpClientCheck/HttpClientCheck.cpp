@@ -0,0 +1,240 @@
+/**
+ * @file HttpClientCheck.cpp
+ * @brief Checks of HttpClient and HttpConnectionPool against a local stand-in server, for Linux
+ *
+ * Starts a stand-in for the telemetry collector on a free port of 127.0.0.1, then runs the
+ * HttpClient of the library (compiled with extras/host) against it and checks the results,
+ * including what the server actually received. Prints one line per check and exits with a
+ * non-zero status when one of them fails.
+ *
+ * Routes of the stand-in server (HTTP/1.1, keep-alive):
+ * - /telemetry: "200 OK" with a Content-Length body
+ * - /chunked: "200 OK" with a chunked body sent in several pieces
+ * - /drop: reads the request and closes the connection without answering (like a server
+ *   that closed an idle connection just as it was reused)
+ * - /slow: answers after 1.5 s
+ *
+ * Build and usage: see extras/README.md.
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include "HostClient.h"
+#include "RequestsAndResponses.h"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Requests received by the stand-in server, by "<METHOD> <path>"
+static std::map<std::string, int> received;
+static std::mutex receivedMutex;
+
+static int failures = 0;
+
+static int countOf(const std::string &request)
+{
+    std::lock_guard<std::mutex> lock(receivedMutex);
+    return received[request];
+}
+
+static void check(bool ok, const char *what)
+{
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static bool sendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Serves the requests of one connection until the client closes it
+static void serveConnection(int fd)
+{
+    std::string input;
+    char buffer[1024];
+    while (true)
+    {
+        size_t headEnd;
+        while ((headEnd = input.find("\r\n\r\n")) == std::string::npos)
+        {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+            {
+                close(fd);
+                return;
+            }
+            input.append(buffer, n);
+        }
+
+        std::string head = input.substr(0, headEnd);
+        size_t contentLength = 0;
+        size_t lengthField = head.find("Content-Length: ");
+        if (lengthField != std::string::npos)
+        {
+            contentLength = strtoul(head.c_str() + lengthField + 16, NULL, 10);
+        }
+        while (input.size() < headEnd + 4 + contentLength)
+        {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+            {
+                close(fd);
+                return;
+            }
+            input.append(buffer, n);
+        }
+        input.erase(0, headEnd + 4 + contentLength);
+
+        // "<METHOD> <path> HTTP/1.1"
+        std::string request = head.substr(0, head.find(" HTTP/"));
+        std::string path = request.substr(request.find(' ') + 1);
+        {
+            std::lock_guard<std::mutex> lock(receivedMutex);
+            received[request]++;
+        }
+
+        if (path == "/drop")
+        {
+            close(fd);
+            return;
+        }
+        if (path == "/slow")
+        {
+            usleep(1500 * 1000);
+        }
+
+        bool ok;
+        if (path == "/chunked")
+        {
+            ok = sendAll(fd, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n7\r\nHello, \r\n");
+            usleep(20 * 1000);
+            ok = ok && sendAll(fd, "8\r\nchunked \r\n");
+            usleep(20 * 1000);
+            ok = ok && sendAll(fd, "5\r\nworld\r\n0\r\n\r\n");
+        }
+        else if (path == "/telemetry" || path == "/slow")
+        {
+            ok = sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+        }
+        else
+        {
+            ok = sendAll(fd, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        }
+        if (!ok)
+        {
+            close(fd);
+            return;
+        }
+    }
+}
+
+static int startServer(uint16_t &port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0; // Any free port
+    socklen_t length = sizeof(address);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 16) != 0 ||
+        getsockname(fd, (struct sockaddr *)&address, &length) != 0)
+    {
+        return -1;
+    }
+    port = ntohs(address.sin_port);
+
+    std::thread([fd]()
+                {
+                    while (true)
+                    {
+                        int client = accept(fd, NULL, NULL);
+                        if (client >= 0)
+                        {
+                            std::thread(serveConnection, client).detach();
+                        }
+                    } })
+        .detach();
+    return fd;
+}
+
+int main()
+{
+    uint16_t port;
+    if (startServer(port) < 0)
+    {
+        printf("Unable to start the stand-in server\n");
+        return 2;
+    }
+    printf("Stand-in server on port %u\n", port);
+
+    HostClient connections[2];
+    HttpConnectionPool pool(5000);
+    for (HostClient &connection : connections)
+    {
+        pool.addClient(connection);
+    }
+
+    HttpClient http(pool);
+    std::string body;
+    http.onBody([&](const uint8_t *data, size_t size)
+                { body.append((const char *)data, size); });
+
+    // Keep-alive: the second request reuses the connection
+    const char *telemetry = "{\"uptime\":1}";
+    int first = http.post("127.0.0.1", port, "/telemetry", ContentType::APPLICATION_JSON, telemetry);
+    body.clear();
+    int second = http.post("127.0.0.1", port, "/telemetry", ContentType::APPLICATION_JSON, telemetry);
+    check(first == 200 && second == 200 && body == "ok", "POST /telemetry answered twice with its body");
+    check(pool.getOpened() == 1 && pool.getReused() == 1, "second request reused the connection");
+
+    body.clear();
+    check(http.get("127.0.0.1", port, "/chunked") == 200 && body == "Hello, chunked world", "chunked body reassembled");
+
+    // Closed without an answer on a reused connection: an idempotent request is sent again once
+    int dropped = http.get("127.0.0.1", port, "/drop");
+    check(dropped == HttpClient::INVALID_RESPONSE && countOf("GET /drop") == 2, "GET closed unanswered is sent again once");
+
+    http.get("127.0.0.1", port, "/telemetry"); // Back to a reused connection
+    dropped = http.post("127.0.0.1", port, "/drop", ContentType::APPLICATION_JSON, telemetry);
+    check(dropped == HttpClient::INVALID_RESPONSE && countOf("POST /drop") == 1, "POST closed unanswered is not sent again");
+
+    // A timeout is never followed by a second request: the server may be handling the first one
+    http.setTimeout(500);
+    http.get("127.0.0.1", port, "/telemetry");
+    int slowPost = http.post("127.0.0.1", port, "/slow", ContentType::APPLICATION_JSON, telemetry);
+    http.get("127.0.0.1", port, "/telemetry");
+    int slowGet = http.get("127.0.0.1", port, "/slow");
+    usleep(2000 * 1000);
+    check(slowPost == HttpClient::TIMED_OUT && countOf("POST /slow") == 1, "POST that timed out is not sent again");
+    check(slowGet == HttpClient::TIMED_OUT && countOf("GET /slow") == 1, "GET that timed out is not sent again");
+
+    printf("%s (%d failed)\n", failures == 0 ? "All checks passed" : "Some checks failed", failures);
+    return failures == 0 ? 0 : 1;
+}
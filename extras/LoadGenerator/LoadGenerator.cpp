@@ -0,0 +1,1085 @@
+/**
+ * @file LoadGenerator.cpp
+ * @brief HTTP/1.1 load generator with latency histograms, for Linux
+ *
+ * Opens N concurrent connections to a server (the host build in extras/host, or a board on
+ * the network), replays a weighted mix of requests and reports requests/s, bytes/s and the
+ * latency distribution (p50, p90, p99, p99.9), overall and per request of the mix.
+ *
+ * Features:
+ * - Single thread, non-blocking sockets and epoll
+ * - Keep-alive or one connection per request (-C), reconnecting when the server closes
+ * - Pipelining (-P): up to depth requests in flight on each connection; requests the server
+ *   did not answer before closing are sent again on a new connection
+ * - Latencies recorded in a log-linear histogram (HDR-style, 3 significant digits, 1 us to
+ *   over an hour) in microseconds, from the moment the request is queued to the last byte of
+ *   its response
+ * - Reproducible request sequence (-s seed), warm-up period excluded from the results
+ *
+ * Request mix file (-m): one request per line, "<weight> <METHOD> <path> [body]"; blank lines
+ * and lines starting with '#' are ignored. Without -m the mix replays the routes of the
+ * WebServer, WebServerCache and WebServerGzip examples as served by extras/host.
+ *
+ * Build and usage: see extras/README.md.
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+static uint64_t nowMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * @class Histogram
+ * @brief Log-linear histogram of values in microseconds (HDR histogram layout).
+ *
+ * Values below 2048 are counted exactly; above that, each power of two is divided in 1024
+ * buckets, so every value is recorded with a relative error below 0.1%.
+ */
+class Histogram
+{
+public:
+    Histogram() : _counts((BUCKETS + 1) * HALF_SUB_BUCKETS, 0)
+    {
+        _total = 0;
+        _sum = 0;
+        _min = UINT64_MAX;
+        _max = 0;
+    }
+
+    void record(uint64_t value)
+    {
+        size_t index = indexOf(value);
+        if (index >= _counts.size())
+        {
+            index = _counts.size() - 1;
+        }
+        _counts[index]++;
+        _total++;
+        _sum += value;
+        _min = value < _min ? value : _min;
+        _max = value > _max ? value : _max;
+    }
+
+    void add(const Histogram &other)
+    {
+        for (size_t i = 0; i < _counts.size(); i++)
+        {
+            _counts[i] += other._counts[i];
+        }
+        _total += other._total;
+        _sum += other._sum;
+        _min = other._min < _min ? other._min : _min;
+        _max = other._max > _max ? other._max : _max;
+    }
+
+    // Smallest value such that the given percentage of the values are less than or equal to it
+    uint64_t percentile(double percent)
+    {
+        if (_total == 0)
+        {
+            return 0;
+        }
+
+        uint64_t wanted = (uint64_t)(percent / 100.0 * _total + 0.5);
+        wanted = wanted < 1 ? 1 : wanted;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < _counts.size(); i++)
+        {
+            seen += _counts[i];
+            if (seen >= wanted)
+            {
+                uint64_t value = highestValueOf(i);
+                return value < _max ? value : _max;
+            }
+        }
+        return _max;
+    }
+
+    uint64_t count() { return _total; }
+    uint64_t min() { return _total > 0 ? _min : 0; }
+    uint64_t max() { return _max; }
+    double mean() { return _total > 0 ? (double)_sum / _total : 0; }
+
+private:
+    static const int SUB_BUCKET_BITS = 11;
+    static const uint64_t HALF_SUB_BUCKETS = 1 << (SUB_BUCKET_BITS - 1);
+    static const int BUCKETS = 22; // Up to 2^32 us
+
+    static size_t indexOf(uint64_t value)
+    {
+        // Bucket 0 holds 0..2047 with a step of 1; bucket b holds 2^(b+10)..2^(b+11)-1 with a step of 2^b
+        int bucket = 63 - __builtin_clzll(value | ((1 << SUB_BUCKET_BITS) - 1)) - (SUB_BUCKET_BITS - 1);
+        size_t subBucket = value >> bucket;
+        return (bucket + 1) * HALF_SUB_BUCKETS + subBucket - HALF_SUB_BUCKETS;
+    }
+
+    static uint64_t highestValueOf(size_t index)
+    {
+        int bucket = index / HALF_SUB_BUCKETS - 1;
+        uint64_t subBucket = index % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+        if (bucket < 0)
+        {
+            bucket = 0;
+            subBucket -= HALF_SUB_BUCKETS;
+        }
+        return ((subBucket + 1) << bucket) - 1;
+    }
+
+    std::vector<uint64_t> _counts;
+    uint64_t _total;
+    uint64_t _sum;
+    uint64_t _min;
+    uint64_t _max;
+};
+
+/**
+ * @brief Request of the mix, with its wire form built once.
+ */
+struct MixEntry
+{
+    unsigned weight;
+    std::string method;
+    std::string path;
+    std::string wire;
+    Histogram latency;
+    uint64_t errors;
+};
+
+/**
+ * @class ResponseReader
+ * @brief Incremental parser of HTTP/1.x responses (Content-Length, chunked or until close).
+ */
+class ResponseReader
+{
+public:
+    enum Progress
+    {
+        NEED_MORE,
+        COMPLETE,
+        FAILED
+    };
+
+    void begin(bool head)
+    {
+        _state = STATUS_LINE;
+        _head = head;
+        _line.clear();
+        _status = 0;
+        _remaining = 0;
+        _contentLength = -1;
+        _chunked = false;
+        _close = false;
+        _minorVersion = 1;
+    }
+
+    // Consumes bytes of data up to the end of the response; *used receives the bytes consumed
+    Progress parse(const char *data, size_t size, size_t *used)
+    {
+        size_t i = 0;
+        while (i < size)
+        {
+            if (_state == BODY || _state == CHUNK_DATA || _state == UNTIL_CLOSE)
+            {
+                size_t n = size - i;
+                if (_state != UNTIL_CLOSE && n > _remaining)
+                {
+                    n = _remaining;
+                }
+                i += n;
+                if (_state == UNTIL_CLOSE)
+                {
+                    continue;
+                }
+                _remaining -= n;
+                if (_remaining == 0)
+                {
+                    if (_state == BODY)
+                    {
+                        _state = DONE;
+                    }
+                    else
+                    {
+                        _state = CHUNK_DATA_END;
+                    }
+                }
+            }
+            else
+            {
+                const char *end = (const char *)memchr(data + i, '\n', size - i);
+                if (end == NULL)
+                {
+                    _line.append(data + i, size - i);
+                    i = size;
+                    if (_line.size() > 8192)
+                    {
+                        _state = ERROR;
+                    }
+                }
+                else
+                {
+                    _line.append(data + i, end - (data + i));
+                    i = end - data + 1;
+                    if (!_line.empty() && _line.back() == '\r')
+                    {
+                        _line.pop_back();
+                    }
+                    processLine();
+                    _line.clear();
+                }
+            }
+
+            if (_state == DONE || _state == ERROR)
+            {
+                break;
+            }
+        }
+
+        *used = i;
+        if (_state == ERROR)
+        {
+            return FAILED;
+        }
+        return _state == DONE ? COMPLETE : NEED_MORE;
+    }
+
+    // Called when the connection closes: completes a response delimited by the close
+    Progress finish()
+    {
+        if (_state == UNTIL_CLOSE)
+        {
+            _state = DONE;
+            return COMPLETE;
+        }
+        return FAILED;
+    }
+
+    bool started() { return _state != STATUS_LINE || !_line.empty(); }
+    bool closeAfter() { return _close || _state == UNTIL_CLOSE; }
+    int status() { return _status; }
+
+private:
+    enum State
+    {
+        STATUS_LINE,
+        HEADERS,
+        BODY,
+        UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILERS,
+        DONE,
+        ERROR
+    };
+
+    void processLine()
+    {
+        const char *line = _line.c_str();
+        switch (_state)
+        {
+        case STATUS_LINE:
+            if (strncmp(line, "HTTP/1.", 7) != 0 || strlen(line) < 12)
+            {
+                _state = ERROR;
+                return;
+            }
+            _minorVersion = line[7] - '0';
+            _status = atoi(line + 9);
+            _close = _minorVersion == 0;
+            _state = HEADERS;
+            break;
+        case HEADERS:
+            if (_line.empty())
+            {
+                endHeaders();
+            }
+            else if (strncasecmp(line, "Content-Length:", 15) == 0)
+            {
+                _contentLength = strtoll(line + 15, NULL, 10);
+            }
+            else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0)
+            {
+                _chunked = strcasestr(line + 18, "chunked") != NULL;
+            }
+            else if (strncasecmp(line, "Connection:", 11) == 0)
+            {
+                if (strcasestr(line + 11, "close") != NULL)
+                {
+                    _close = true;
+                }
+                else if (strcasestr(line + 11, "keep-alive") != NULL)
+                {
+                    _close = false;
+                }
+            }
+            break;
+        case CHUNK_SIZE:
+            _remaining = strtoull(line, NULL, 16);
+            _state = _remaining > 0 ? CHUNK_DATA : TRAILERS;
+            break;
+        case CHUNK_DATA_END:
+            _state = CHUNK_SIZE;
+            break;
+        case TRAILERS:
+            if (_line.empty())
+            {
+                _state = DONE;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void endHeaders()
+    {
+        if (_status >= 100 && _status < 200)
+        {
+            // Interim response (100 Continue): the final one follows
+            bool head = _head;
+            begin(head);
+            return;
+        }
+
+        if (_head || _status == 204 || _status == 304)
+        {
+            _state = DONE;
+        }
+        else if (_chunked)
+        {
+            _state = CHUNK_SIZE;
+        }
+        else if (_contentLength >= 0)
+        {
+            _remaining = _contentLength;
+            _state = _remaining > 0 ? BODY : DONE;
+        }
+        else
+        {
+            _state = UNTIL_CLOSE;
+        }
+    }
+
+    State _state;
+    bool _head;
+    std::string _line;
+    int _status;
+    uint64_t _remaining;
+    long long _contentLength;
+    bool _chunked;
+    bool _close;
+    int _minorVersion;
+};
+
+/**
+ * @brief Request sent and waiting for its response.
+ */
+struct Pending
+{
+    MixEntry *entry;
+    uint64_t queuedAt;
+};
+
+/**
+ * @brief Client connection and its requests in flight.
+ */
+struct Connection
+{
+    int fd;
+    bool connecting;
+    uint64_t retryAt;
+    std::string output;
+    size_t outputSent;
+    std::deque<Pending> pending;  // Sent, oldest first
+    std::deque<Pending> unsent;   // To send again after a reconnection
+    ResponseReader response;
+    bool responseStarted;
+    uint32_t generation; // Incremented on each reconnection
+};
+
+/**
+ * @brief Command line options.
+ */
+struct Options
+{
+    const char *host = "127.0.0.1";
+    const char *port = "8080";
+    unsigned connections = 10;
+    unsigned depth = 1;
+    double duration = 10;
+    double warmup = 1;
+    uint64_t maxRequests = 0;
+    bool close = false;
+    bool gzip = false;
+    uint32_t seed = 1;
+    const char *mixFile = NULL;
+    std::vector<std::string> headers;
+};
+
+static const char DEFAULT_MIX[] =
+    "30 GET /test\n"
+    "10 GET /version\n"
+    "10 GET /index.html\n"
+    "10 GET /assets/js/script.js\n"
+    "10 GET /assets/bootstrap/css/bootstrap.min.css\n"
+    "10 GET /gzip/assets/bootstrap/css/bootstrap.min.css\n"
+    "10 GET /gzip/assets/bootstrap/js/bootstrap.min.js\n"
+    "10 POST /status-led led=on\n";
+
+static volatile bool interrupted = false;
+
+static void interrupt(int)
+{
+    interrupted = true;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -h host        server address (127.0.0.1)\n"
+            "  -p port        server port (8080)\n"
+            "  -c count       concurrent connections (10)\n"
+            "  -P depth       requests in flight per connection, pipelining when > 1 (1)\n"
+            "  -d seconds     duration of the measurement (10)\n"
+            "  -w seconds     warm-up before the measurement, not reported (1)\n"
+            "  -n count       stop after this many measured requests (no limit)\n"
+            "  -m file        request mix, one \"<weight> <METHOD> <path> [body]\" per line\n"
+            "  -H header      extra header sent with every request (repeatable)\n"
+            "  -C             one request per connection (Connection: close)\n"
+            "  -z             accept gzip (Accept-Encoding: gzip)\n"
+            "  -s seed        seed of the request sequence (1)\n",
+            name);
+}
+
+static bool parseMix(const char *text, const Options &options, std::vector<MixEntry> &mix)
+{
+    const char *line = text;
+    while (*line != '\0')
+    {
+        const char *end = strchr(line, '\n');
+        std::string current(line, end != NULL ? end - line : strlen(line));
+        line = end != NULL ? end + 1 : line + current.size();
+
+        if (!current.empty() && current.back() == '\r')
+        {
+            current.pop_back();
+        }
+        if (current.empty() || current[0] == '#')
+        {
+            continue;
+        }
+
+        unsigned weight;
+        char method[16];
+        char path[1024];
+        int consumed = 0;
+        if (sscanf(current.c_str(), "%u %15s %1023s %n", &weight, method, path, &consumed) < 3 || weight == 0)
+        {
+            fprintf(stderr, "Invalid mix line: %s\n", current.c_str());
+            return false;
+        }
+        std::string body = consumed > 0 ? current.substr(consumed) : "";
+
+        MixEntry entry;
+        entry.weight = weight;
+        entry.method = method;
+        entry.path = path;
+        entry.errors = 0;
+
+        entry.wire = entry.method + " " + entry.path + " HTTP/1.1\r\nHost: " + options.host + "\r\n";
+        entry.wire += "User-Agent: LoadGenerator\r\n";
+        entry.wire += options.close ? "Connection: close\r\n" : "Connection: keep-alive\r\n";
+        if (options.gzip)
+        {
+            entry.wire += "Accept-Encoding: gzip\r\n";
+        }
+        for (const std::string &header : options.headers)
+        {
+            entry.wire += header + "\r\n";
+        }
+        if (!body.empty() || entry.method == "POST" || entry.method == "PUT")
+        {
+            entry.wire += "Content-Type: application/x-www-form-urlencoded\r\n";
+            entry.wire += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        entry.wire += "\r\n" + body;
+        mix.push_back(entry);
+    }
+    return !mix.empty();
+}
+
+static bool readFile(const char *path, std::string &text)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        text.append(buffer, n);
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @class LoadGenerator
+ * @brief Event loop driving all the connections.
+ */
+class LoadGenerator
+{
+public:
+    LoadGenerator(const Options &options, std::vector<MixEntry> &mix, const struct addrinfo *address)
+        : _options(options), _mix(mix), _address(address), _connections(options.connections)
+    {
+        _random = options.seed != 0 ? options.seed : 1;
+        _totalWeight = 0;
+        for (const MixEntry &entry : mix)
+        {
+            _totalWeight += entry.weight;
+        }
+        _measuring = false;
+        _measureStart = 0;
+        _measured = 0;
+        _bytes = 0;
+        _opened = 0;
+        _connectErrors = 0;
+        _resent = 0;
+        _errors = 0;
+        memset(_statusCounts, 0, sizeof(_statusCounts));
+    }
+
+    int run()
+    {
+        _epoll = epoll_create1(0);
+        if (_epoll < 0)
+        {
+            perror("epoll_create1");
+            return 1;
+        }
+
+        uint64_t start = nowMicros();
+        uint64_t measureStart = start + (uint64_t)(_options.warmup * 1e6);
+        uint64_t measureEnd = measureStart + (uint64_t)(_options.duration * 1e6);
+
+        for (Connection &connection : _connections)
+        {
+            connection.fd = -1;
+            connection.generation = 0;
+            open(connection);
+        }
+
+        struct epoll_event events[256];
+        while (!interrupted)
+        {
+            uint64_t now = nowMicros();
+            if (!_measuring && now >= measureStart)
+            {
+                _measuring = true;
+                _measureStart = now;
+            }
+            if (now >= measureEnd || (_options.maxRequests > 0 && _measured >= _options.maxRequests))
+            {
+                break;
+            }
+
+            int count = epoll_wait(_epoll, events, 256, 10);
+            for (int i = 0; i < count; i++)
+            {
+                Connection &connection = _connections[events[i].data.u32];
+                if (connection.fd < 0)
+                {
+                    continue;
+                }
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && connection.connecting)
+                {
+                    connectFailed(connection);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT)
+                {
+                    writable(connection);
+                }
+                if (connection.fd >= 0 && events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                {
+                    readable(connection);
+                }
+            }
+
+            // Connections waiting to reconnect after an error
+            now = nowMicros();
+            for (Connection &connection : _connections)
+            {
+                if (connection.fd < 0 && now >= connection.retryAt)
+                {
+                    open(connection);
+                }
+            }
+        }
+
+        uint64_t elapsed = nowMicros() - (_measuring ? _measureStart : start);
+        for (Connection &connection : _connections)
+        {
+            if (connection.fd >= 0)
+            {
+                ::close(connection.fd);
+            }
+        }
+        ::close(_epoll);
+
+        report(elapsed);
+        return 0;
+    }
+
+private:
+    MixEntry *nextEntry()
+    {
+        // xorshift32: the same seed gives the same sequence of requests
+        _random ^= _random << 13;
+        _random ^= _random >> 17;
+        _random ^= _random << 5;
+
+        uint32_t pick = _random % _totalWeight;
+        for (MixEntry &entry : _mix)
+        {
+            if (pick < entry.weight)
+            {
+                return &entry;
+            }
+            pick -= entry.weight;
+        }
+        return &_mix.back();
+    }
+
+    uint32_t indexOf(Connection &connection)
+    {
+        return &connection - &_connections[0];
+    }
+
+    void open(Connection &connection)
+    {
+        connection.output.clear();
+        connection.outputSent = 0;
+        connection.pending.clear();
+        connection.responseStarted = false;
+        connection.retryAt = 0;
+        connection.generation++;
+
+        connection.fd = socket(_address->ai_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (connection.fd < 0)
+        {
+            perror("socket");
+            interrupted = true;
+            return;
+        }
+        int one = 1;
+        setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        connection.connecting = true;
+        if (::connect(connection.fd, _address->ai_addr, _address->ai_addrlen) != 0 && errno != EINPROGRESS)
+        {
+            connectFailed(connection);
+            return;
+        }
+
+        struct epoll_event event = {};
+        event.events = EPOLLIN | EPOLLOUT;
+        event.data.u32 = indexOf(connection);
+        epoll_ctl(_epoll, EPOLL_CTL_ADD, connection.fd, &event);
+    }
+
+    void close(Connection &connection)
+    {
+        // Requests without a response are sent again on the next connection, with their original times
+        while (!connection.pending.empty())
+        {
+            connection.unsent.push_front(connection.pending.back());
+            connection.pending.pop_back();
+            _resent++;
+        }
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, connection.fd, NULL);
+        ::close(connection.fd);
+        connection.fd = -1;
+    }
+
+    void connectFailed(Connection &connection)
+    {
+        if (_measuring)
+        {
+            _connectErrors++;
+        }
+        close(connection);
+        connection.retryAt = nowMicros() + 10000; // Avoids spinning while the server refuses connections
+    }
+
+    void fill(Connection &connection)
+    {
+        // With "Connection: close" only one request per connection makes sense
+        size_t depth = _options.close ? 1 : _options.depth;
+        while (connection.pending.size() < depth)
+        {
+            Pending request;
+            if (!connection.unsent.empty())
+            {
+                request = connection.unsent.front();
+                connection.unsent.pop_front();
+            }
+            else
+            {
+                request.entry = nextEntry();
+                request.queuedAt = nowMicros();
+            }
+            connection.output += request.entry->wire;
+            connection.pending.push_back(request);
+        }
+    }
+
+    void flush(Connection &connection)
+    {
+        while (connection.outputSent < connection.output.size())
+        {
+            ssize_t sent = send(connection.fd, connection.output.data() + connection.outputSent,
+                                connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+            if (sent <= 0)
+            {
+                if (sent < 0 && errno != EAGAIN)
+                {
+                    closed(connection);
+                }
+                return; // EPOLLOUT resumes
+            }
+            connection.outputSent += sent;
+        }
+        connection.output.clear();
+        connection.outputSent = 0;
+    }
+
+    void writable(Connection &connection)
+    {
+        if (connection.connecting)
+        {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0)
+            {
+                connectFailed(connection);
+                return;
+            }
+            connection.connecting = false;
+            if (_measuring)
+            {
+                _opened++;
+            }
+
+            struct epoll_event event = {};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+            event.data.u32 = indexOf(connection);
+            epoll_ctl(_epoll, EPOLL_CTL_MOD, connection.fd, &event);
+
+            fill(connection);
+            connection.response.begin(connection.pending.front().entry->method == "HEAD");
+            connection.responseStarted = false;
+        }
+        flush(connection);
+    }
+
+    void readable(Connection &connection)
+    {
+        char buffer[65536];
+        uint32_t generation = connection.generation;
+        while (connection.generation == generation)
+        {
+            ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (received < 0)
+            {
+                if (errno != EAGAIN)
+                {
+                    closed(connection);
+                }
+                return;
+            }
+            if (received == 0)
+            {
+                closed(connection);
+                return;
+            }
+
+            if (_measuring)
+            {
+                _bytes += received;
+            }
+
+            size_t offset = 0;
+            while (offset < (size_t)received && !connection.pending.empty())
+            {
+                size_t used;
+                ResponseReader::Progress progress = connection.response.parse(buffer + offset, received - offset, &used);
+                offset += used;
+                connection.responseStarted = true;
+
+                if (progress == ResponseReader::FAILED)
+                {
+                    failed(connection);
+                    return;
+                }
+                if (progress == ResponseReader::COMPLETE)
+                {
+                    completed(connection);
+                    if (connection.generation != generation)
+                    {
+                        return; // Reconnected: the rest of the data belonged to the old connection
+                    }
+                }
+            }
+        }
+    }
+
+    void completed(Connection &connection)
+    {
+        Pending request = connection.pending.front();
+        connection.pending.pop_front();
+
+        if (_measuring)
+        {
+            uint64_t latency = nowMicros() - request.queuedAt;
+            request.entry->latency.record(latency);
+            int status = connection.response.status();
+            _statusCounts[status >= 100 && status < 600 ? status / 100 : 0]++;
+            _measured++;
+        }
+
+        if (_options.close || connection.response.closeAfter())
+        {
+            // The connection ends with this response: the requests in flight are sent on a new one
+            close(connection);
+            open(connection);
+            return;
+        }
+
+        fill(connection);
+        connection.response.begin(connection.pending.front().entry->method == "HEAD");
+        connection.responseStarted = false;
+        flush(connection);
+    }
+
+    void closed(Connection &connection)
+    {
+        if (!connection.pending.empty() && connection.responseStarted &&
+            connection.response.finish() == ResponseReader::COMPLETE)
+        {
+            completed(connection); // Response delimited by the end of the connection (reopens)
+            return;
+        }
+        if (!connection.pending.empty() && connection.responseStarted)
+        {
+            failed(connection); // Connection closed in the middle of a response
+            return;
+        }
+        close(connection);
+        open(connection);
+    }
+
+    void failed(Connection &connection)
+    {
+        if (_measuring)
+        {
+            connection.pending.front().entry->errors++;
+            _errors++;
+        }
+        connection.pending.pop_front(); // Not sent again
+        close(connection);
+        open(connection);
+    }
+
+    static void printLatency(const char *label, Histogram &histogram)
+    {
+        printf("  %-44s %9llu %9llu %9llu %9llu %9llu %9llu\n", label,
+               (unsigned long long)histogram.count(),
+               (unsigned long long)histogram.percentile(50),
+               (unsigned long long)histogram.percentile(90),
+               (unsigned long long)histogram.percentile(99),
+               (unsigned long long)histogram.percentile(99.9),
+               (unsigned long long)histogram.max());
+    }
+
+    void report(uint64_t elapsedMicros)
+    {
+        double seconds = elapsedMicros / 1e6;
+        Histogram all;
+        for (MixEntry &entry : _mix)
+        {
+            all.add(entry.latency);
+        }
+
+        printf("%s:%s, %u connections, pipeline depth %u, %s%s\n", _options.host, _options.port,
+               _options.connections, _options.close ? 1 : _options.depth,
+               _options.close ? "Connection: close" : "keep-alive", _options.gzip ? ", gzip" : "");
+        printf("Duration:    %.2f s\n", seconds);
+        printf("Requests:    %llu (%.1f req/s)\n", (unsigned long long)all.count(), all.count() / seconds);
+        printf("Transfer:    %.2f MB (%.2f MB/s)\n", _bytes / 1e6, _bytes / 1e6 / seconds);
+        printf("Connections: %llu opened, %llu connect errors, %llu requests sent again, %llu failed responses\n",
+               (unsigned long long)_opened, (unsigned long long)_connectErrors,
+               (unsigned long long)_resent, (unsigned long long)_errors);
+        printf("Status:      1xx %llu, 2xx %llu, 3xx %llu, 4xx %llu, 5xx %llu\n",
+               (unsigned long long)_statusCounts[1], (unsigned long long)_statusCounts[2],
+               (unsigned long long)_statusCounts[3], (unsigned long long)_statusCounts[4],
+               (unsigned long long)_statusCounts[5]);
+        printf("Latency:     min %llu us, mean %.0f us\n", (unsigned long long)all.min(), all.mean());
+
+        printf("\n  %-44s %9s %9s %9s %9s %9s %9s\n", "Latency (us)", "count", "p50", "p90", "p99", "p99.9", "max");
+        printLatency("all", all);
+        for (MixEntry &entry : _mix)
+        {
+            std::string label = entry.method + " " + entry.path;
+            if (label.size() > 44)
+            {
+                label = label.substr(0, 41) + "...";
+            }
+            printLatency(label.c_str(), entry.latency);
+        }
+    }
+
+    const Options &_options;
+    std::vector<MixEntry> &_mix;
+    const struct addrinfo *_address;
+    std::vector<Connection> _connections;
+    int _epoll;
+
+    uint32_t _random;
+    uint32_t _totalWeight;
+    bool _measuring;
+    uint64_t _measureStart;
+    uint64_t _measured;
+    uint64_t _bytes;
+    uint64_t _opened;
+    uint64_t _connectErrors;
+    uint64_t _resent;
+    uint64_t _errors;
+    uint64_t _statusCounts[6];
+};
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    int option;
+    while ((option = getopt(argc, argv, "h:p:c:P:d:w:n:m:H:Czs:")) != -1)
+    {
+        switch (option)
+        {
+        case 'h':
+            options.host = optarg;
+            break;
+        case 'p':
+            options.port = optarg;
+            break;
+        case 'c':
+            options.connections = atoi(optarg);
+            break;
+        case 'P':
+            options.depth = atoi(optarg);
+            break;
+        case 'd':
+            options.duration = atof(optarg);
+            break;
+        case 'w':
+            options.warmup = atof(optarg);
+            break;
+        case 'n':
+            options.maxRequests = strtoull(optarg, NULL, 10);
+            break;
+        case 'm':
+            options.mixFile = optarg;
+            break;
+        case 'H':
+            options.headers.push_back(optarg);
+            break;
+        case 'C':
+            options.close = true;
+            break;
+        case 'z':
+            options.gzip = true;
+            break;
+        case 's':
+            options.seed = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.connections == 0 || options.depth == 0 || options.duration <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string mixText = DEFAULT_MIX;
+    if (options.mixFile != NULL)
+    {
+        mixText.clear();
+        if (!readFile(options.mixFile, mixText))
+        {
+            fprintf(stderr, "Unable to read %s\n", options.mixFile);
+            return 1;
+        }
+    }
+    std::vector<MixEntry> mix;
+    if (!parseMix(mixText.c_str(), options, mix))
+    {
+        fprintf(stderr, "Empty request mix\n");
+        return 1;
+    }
+
+    struct addrinfo hints = {};
+    struct addrinfo *address;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int error = getaddrinfo(options.host, options.port, &hints, &address);
+    if (error != 0)
+    {
+        fprintf(stderr, "%s: %s\n", options.host, gai_strerror(error));
+        return 1;
+    }
+
+    signal(SIGINT, interrupt);
+    signal(SIGPIPE, SIG_IGN);
+
+    LoadGenerator generator(options, mix, address);
+    int result = generator.run();
+    freeaddrinfo(address);
+    return result;
+}
@@ -0,0 +1,295 @@
+/**
+ * @file UploadCheck.cpp
+ * @brief Checks of UploadEngine with a FileSink, for Linux
+ *
+ * Runs the upload path of the Esp32OTW example on the host: each check sends a request to a
+ * local socket from a separate thread, while the main thread reads it with RequestReader and
+ * receives the body with an UploadEngine writing to a FileSink (the file-backed stand-in for
+ * UpdateSink) in a temporary directory. The response, the file written and the SHA-256
+ * computed by the engine are then checked. Prints one line per check and exits with a
+ * non-zero status when one of them fails.
+ *
+ * The digests are the test vectors of FIPS 180-2 ("abc" and one million 'a'), so the hash is
+ * checked against known values rather than against itself.
+ *
+ * Build and usage: see extras/README.md.
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include "HostClient.h"
+#include "RequestsAndResponses.h"
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+
+// SHA-256 of "abc" and of one million 'a' (FIPS 180-2)
+static const char *const ABC_HEX = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+static const char *const ABC_BASE64 = "ungWv48Bz+pBQUDeXa4iI7ADYaOWF3qctBD/YfIAFa0=";
+static const char *const MILLION_A_HEX = "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+
+static const char *const UPLOAD_PATH = "/upload.bin";
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/**
+ * @brief Request sent by the client thread: the head, the body and how much of it to send.
+ */
+struct Upload
+{
+    std::string head;
+    std::string body;
+    size_t bodySent;
+    bool waitContinue;
+};
+
+static bool sendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Reads until the end of a response head, or until the connection is closed
+static std::string readHead(int fd)
+{
+    std::string input;
+    char c;
+    while (input.find("\r\n\r\n") == std::string::npos && recv(fd, &c, 1, 0) == 1)
+    {
+        input += c;
+    }
+    return input;
+}
+
+static std::string readAll(int fd)
+{
+    std::string input;
+    char buffer[1024];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+    {
+        input.append(buffer, n);
+    }
+    return input;
+}
+
+// Client side: sends the upload and returns everything the server answered
+static std::string sendUpload(uint16_t port, const Upload &upload)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || !sendAll(fd, upload.head))
+    {
+        return "";
+    }
+
+    std::string answer;
+    if (upload.waitContinue)
+    {
+        // Like curl: the body only follows "100 Continue"
+        answer = readHead(fd);
+        if (answer.compare(0, 21, "HTTP/1.1 100 Continue") != 0)
+        {
+            answer += readAll(fd);
+            close(fd);
+            return answer;
+        }
+    }
+
+    sendAll(fd, upload.body.substr(0, upload.bodySent));
+    answer += readAll(fd);
+    close(fd);
+    return answer;
+}
+
+static int startListening(uint16_t &port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0; // Any free port
+    socklen_t length = sizeof(address);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 4) != 0 ||
+        getsockname(fd, (struct sockaddr *)&address, &length) != 0)
+    {
+        return -1;
+    }
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+static std::string headOf(size_t length, const char *digestHeader, bool expectContinue)
+{
+    char head[256];
+    snprintf(head, sizeof(head), "POST /otw HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/octet-stream\r\n"
+                                 "Content-Length: %lu\r\n%s%s\r\n",
+             (unsigned long)length, digestHeader, expectContinue ? "Expect: 100-continue\r\n" : "");
+    return head;
+}
+
+static std::string hexOf(const uint8_t digest[32])
+{
+    char hex[65];
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+    return hex;
+}
+
+static std::string readFile(fs::FS &files, const char *path)
+{
+    std::string content;
+    File file = files.open(path);
+    uint8_t buffer[4096];
+    size_t n;
+    while (file && (n = file.read(buffer, sizeof(buffer))) > 0)
+    {
+        content.append((const char *)buffer, n);
+    }
+    return content;
+}
+
+/**
+ * @brief What the server side saw of one upload.
+ */
+struct Outcome
+{
+    UploadEngine::Result result;
+    std::string digest;
+    std::string response;
+    bool stored;
+    std::string content;
+};
+
+// Server side: receives one upload like the /otw route of the Esp32OTW example, with a FileSink
+static Outcome receiveUpload(int listening, uint16_t port, fs::FS &files, const Upload &upload, size_t maxSize)
+{
+    Outcome outcome;
+    std::thread client([&]()
+                       { outcome.response = sendUpload(port, upload); });
+
+    struct pollfd pfd = {listening, POLLIN, 0};
+    HostClient connection(poll(&pfd, 1, 2000) > 0 ? accept(listening, NULL, NULL) : -1);
+
+    AnalyserRequest request;
+    RequestReader reader(connection, request);
+    FileSink sink(files, UPLOAD_PATH, maxSize);
+    UploadEngine engine(sink);
+    engine.setTimeout(300);
+
+    outcome.result = UploadEngine::DISCONNECTED;
+    if (reader.read() == RequestReader::READY)
+    {
+        outcome.result = engine.receive(connection, request);
+        engine.respond(connection, request);
+    }
+    connection.stop();
+    client.join();
+
+    uint8_t digest[32];
+    engine.getDigest(digest);
+    outcome.digest = hexOf(digest);
+    outcome.stored = files.exists(UPLOAD_PATH);
+    outcome.content = readFile(files, UPLOAD_PATH);
+    files.remove(UPLOAD_PATH);
+    return outcome;
+}
+
+static bool startsWith(const std::string &text, const char *prefix)
+{
+    return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+int main()
+{
+    char directory[] = "/tmp/upload-check-XXXXXX";
+    uint16_t port;
+    int listening = startListening(port);
+    if (mkdtemp(directory) == NULL || listening < 0)
+    {
+        printf("Unable to create the directory or the socket of the checks\n");
+        return 2;
+    }
+    fs::FS files(directory);
+
+    // One million 'a', with Expect: 100-continue: spans many buffers and ends with a partial one
+    Upload upload;
+    upload.body.assign(1000000, 'a');
+    upload.bodySent = upload.body.size();
+    upload.waitContinue = true;
+    upload.head = headOf(upload.body.size(), (std::string("X-SHA256: ") + MILLION_A_HEX + "\r\n").c_str(), true);
+    Outcome outcome = receiveUpload(listening, port, files, upload, 0);
+    check(outcome.result == UploadEngine::COMPLETED && outcome.digest == MILLION_A_HEX, "1000000 x 'a' hashed to the FIPS 180-2 digest");
+    check(startsWith(outcome.response, "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK"), "100 Continue, then 200 OK");
+    check(outcome.content == upload.body, "file written by FileSink matches the upload");
+
+    // "abc" with a Content-Digest header (RFC 9530)
+    upload.body = "abc";
+    upload.bodySent = 3;
+    upload.waitContinue = false;
+    upload.head = headOf(3, (std::string("Content-Digest: sha-256=:") + ABC_BASE64 + ":\r\n").c_str(), false);
+    outcome = receiveUpload(listening, port, files, upload, 0);
+    check(outcome.result == UploadEngine::COMPLETED && outcome.digest == ABC_HEX && outcome.content == "abc",
+          "\"abc\" with Content-Digest stored");
+
+    // Same digest, other content: nothing is kept
+    upload.body = "abd";
+    outcome = receiveUpload(listening, port, files, upload, 0);
+    check(outcome.result == UploadEngine::DIGEST_MISMATCH && startsWith(outcome.response, "HTTP/1.1 422") && !outcome.stored,
+          "digest mismatch answered 422 and the file removed");
+
+    // Larger than the sink accepts: refused before the body is sent
+    upload.body.assign(5000, 'a');
+    upload.waitContinue = true;
+    upload.head = headOf(upload.body.size(), "", true);
+    upload.bodySent = upload.body.size();
+    outcome = receiveUpload(listening, port, files, upload, 4096);
+    check(outcome.result == UploadEngine::NO_SPACE && startsWith(outcome.response, "HTTP/1.1 413") && !outcome.stored,
+          "too large answered 413 without 100 Continue");
+
+    // Body that stops halfway
+    upload.waitContinue = false;
+    upload.head = headOf(upload.body.size(), "", false);
+    upload.bodySent = upload.body.size() / 2;
+    outcome = receiveUpload(listening, port, files, upload, 0);
+    check(outcome.result == UploadEngine::TIMED_OUT && startsWith(outcome.response, "HTTP/1.1 408") && !outcome.stored,
+          "body that stopped halfway answered 408 and the file removed");
+
+    rmdir(directory);
+    printf("%s (%d failed)\n", failures == 0 ? "All checks passed" : "Some checks failed", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include "Arduino.h"
+#include <time.h>
+#include <memory>
+#include <string>
+
+namespace fs
+{
+    /**
+     * @brief File of the host file system, with the interface of the ESP32 fs::File.
+     *
+     * Copies share the same open file, which is closed with the last copy or by close().
+     */
+    class File : public Stream
+    {
+    public:
+        File();
+        File(FILE *file, const std::string &path, bool directory);
+
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        int available() override;
+        int read() override;
+        int peek() override;
+        void flush() override;
+
+        size_t read(uint8_t *buffer, size_t size);
+        bool seek(uint32_t position);
+        size_t position() const;
+        size_t size() const;
+        const char *path() const;
+        bool isDirectory() const;
+        time_t getLastWrite() const;
+        int fd() const;
+        void close();
+        operator bool() const;
+
+    private:
+        std::shared_ptr<FILE> _file;
+        std::string _path;
+        bool _directory;
+    };
+
+    /**
+     * @brief File system rooted at a directory of the host ("/index.html" is "<root>/index.html").
+     */
+    class FS
+    {
+    public:
+        FS(const char *root = ".");
+
+        File open(const char *path, const char *mode = "r", bool create = false);
+        bool exists(const char *path);
+        bool remove(const char *path);
+
+    private:
+        std::string _root;
+    };
+}
+
+using fs::File;
+using fs::FS;
+
+#endif // HOST_FS_H
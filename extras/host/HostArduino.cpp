@@ -0,0 +1,340 @@
+#include "Arduino.h"
+#include "FS.h"
+#include <sched.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t monotonicMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static const uint64_t startMicros = monotonicMicros();
+
+unsigned long millis()
+{
+    return (monotonicMicros() - startMicros) / 1000;
+}
+
+unsigned long micros()
+{
+    return monotonicMicros() - startMicros;
+}
+
+void delay(unsigned long ms)
+{
+    usleep(ms * 1000);
+}
+
+void yield()
+{
+    sched_yield();
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (size-- > 0 && write(*buffer++) == 1)
+    {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::write(const char *text)
+{
+    return text == NULL ? 0 : write((const uint8_t *)text, strlen(text));
+}
+
+int Print::availableForWrite()
+{
+    return 0;
+}
+
+void Print::flush()
+{
+}
+
+size_t Print::print(const char *text)
+{
+    return write(text);
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == 10)
+    {
+        return printf("%ld", value);
+    }
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char text[8 * sizeof(value) + 1];
+    char *digit = &text[sizeof(text) - 1];
+    *digit = '\0';
+    if (base < 2)
+    {
+        base = 10;
+    }
+    do
+    {
+        int remainder = value % base;
+        *--digit = remainder < 10 ? '0' + remainder : 'A' + remainder - 10;
+        value /= base;
+    } while (value > 0);
+    return write(digit);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::println(const char *text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+
+    if (length < 0)
+    {
+        return 0;
+    }
+    if ((size_t)length < sizeof(text))
+    {
+        return write((const uint8_t *)text, length);
+    }
+
+    // Longer than the local buffer
+    char *longText = (char *)malloc(length + 1);
+    if (longText == NULL)
+    {
+        return 0;
+    }
+    va_start(arguments, format);
+    vsnprintf(longText, length + 1, format, arguments);
+    va_end(arguments);
+    size_t written = write((const uint8_t *)longText, length);
+    free(longText);
+    return written;
+}
+
+IPAddress::IPAddress()
+{
+    _address = 0;
+}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+{
+    _address = first | (second << 8) | (third << 16) | ((uint32_t)fourth << 24);
+}
+
+IPAddress::IPAddress(uint32_t address)
+{
+    _address = address;
+}
+
+IPAddress::operator uint32_t() const
+{
+    return _address;
+}
+
+uint8_t IPAddress::operator[](int index) const
+{
+    return (_address >> (8 * index)) & 0xFF;
+}
+
+bool IPAddress::operator==(const IPAddress &other) const
+{
+    return _address == other._address;
+}
+
+namespace fs
+{
+    File::File()
+    {
+        _directory = false;
+    }
+
+    static void closeFile(FILE *file)
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+    }
+
+    File::File(FILE *file, const std::string &path, bool directory) : _file(file, closeFile), _path(path)
+    {
+        _directory = directory;
+    }
+
+    size_t File::write(uint8_t data)
+    {
+        return write(&data, 1);
+    }
+
+    size_t File::write(const uint8_t *buffer, size_t size)
+    {
+        return _file ? fwrite(buffer, 1, size, _file.get()) : 0;
+    }
+
+    int File::available()
+    {
+        return _file ? (int)(size() - position()) : 0;
+    }
+
+    int File::read()
+    {
+        return _file ? fgetc(_file.get()) : -1;
+    }
+
+    int File::peek()
+    {
+        int c = read();
+        if (c >= 0)
+        {
+            ungetc(c, _file.get());
+        }
+        return c;
+    }
+
+    void File::flush()
+    {
+        if (_file)
+        {
+            fflush(_file.get());
+        }
+    }
+
+    size_t File::read(uint8_t *buffer, size_t size)
+    {
+        return _file ? fread(buffer, 1, size, _file.get()) : 0;
+    }
+
+    bool File::seek(uint32_t position)
+    {
+        return _file && fseek(_file.get(), position, SEEK_SET) == 0;
+    }
+
+    size_t File::position() const
+    {
+        return _file ? ftell(_file.get()) : 0;
+    }
+
+    size_t File::size() const
+    {
+        struct stat status;
+        return stat(_path.c_str(), &status) == 0 ? status.st_size : 0;
+    }
+
+    const char *File::path() const
+    {
+        return _path.c_str();
+    }
+
+    bool File::isDirectory() const
+    {
+        return _directory;
+    }
+
+    time_t File::getLastWrite() const
+    {
+        struct stat status;
+        return stat(_path.c_str(), &status) == 0 ? status.st_mtime : 0;
+    }
+
+    int File::fd() const
+    {
+        return _file ? fileno(_file.get()) : -1;
+    }
+
+    void File::close()
+    {
+        _file.reset();
+        _directory = false;
+    }
+
+    File::operator bool() const
+    {
+        return _file || _directory;
+    }
+
+    FS::FS(const char *root) : _root(root)
+    {
+    }
+
+    File FS::open(const char *path, const char *mode, bool create)
+    {
+        (void)create; // fopen() already creates files opened for writing
+        std::string fullPath = _root + path;
+
+        struct stat status;
+        if (stat(fullPath.c_str(), &status) == 0 && S_ISDIR(status.st_mode))
+        {
+            return File(NULL, fullPath, true);
+        }
+
+        const char *hostMode = mode[0] == 'w' ? "wb" : (mode[0] == 'a' ? "ab" : "rb");
+        FILE *file = fopen(fullPath.c_str(), hostMode);
+        return file != NULL ? File(file, fullPath, false) : File();
+    }
+
+    bool FS::exists(const char *path)
+    {
+        struct stat status;
+        return stat((_root + path).c_str(), &status) == 0;
+    }
+
+    bool FS::remove(const char *path)
+    {
+        return ::remove((_root + path).c_str()) == 0;
+    }
+}
@@ -0,0 +1,250 @@
+#include "HostClient.h"
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+HostClient::HostClient()
+{
+    _fd = -1;
+    _reset = false;
+}
+
+HostClient::HostClient(int fd)
+{
+    _fd = fd;
+    _reset = false;
+    if (_fd >= 0)
+    {
+        int one = 1;
+        setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // The library already gathers each response in few writes
+    }
+}
+
+int HostClient::connect(IPAddress ip, uint16_t port)
+{
+    char host[16];
+    snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return connect(host, port);
+}
+
+int HostClient::connect(const char *host, uint16_t port)
+{
+    stop();
+
+    struct addrinfo hints = {};
+    struct addrinfo *addresses;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &addresses) != 0)
+    {
+        return 0;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, addresses->ai_addr, addresses->ai_addrlen) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0)
+    {
+        return 0;
+    }
+    *this = HostClient(fd);
+    return 1;
+}
+
+size_t HostClient::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+size_t HostClient::write(const uint8_t *buffer, size_t size)
+{
+    if (_fd < 0)
+    {
+        return 0;
+    }
+
+    ssize_t sent = send(_fd, buffer, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0 && errno == EAGAIN)
+    {
+        // Buffer full: waits a little for room, the caller retries or gives up
+        struct pollfd pfd = {_fd, POLLOUT, 0};
+        if (poll(&pfd, 1, 100) > 0)
+        {
+            sent = send(_fd, buffer, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        }
+    }
+    if (sent < 0 && errno != EAGAIN)
+    {
+        _reset = true; // The peer is gone (EPIPE, ECONNRESET), like a W5500 socket in the CLOSED state
+    }
+    return sent > 0 ? sent : 0;
+}
+
+int HostClient::availableForWrite()
+{
+    if (_fd < 0)
+    {
+        return 0;
+    }
+
+    int bufferSize = 0;
+    socklen_t length = sizeof(bufferSize);
+    int queued = 0;
+    if (getsockopt(_fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, &length) != 0 || ioctl(_fd, SIOCOUTQ, &queued) != 0)
+    {
+        return 0;
+    }
+    return bufferSize > queued ? bufferSize - queued : 0;
+}
+
+int HostClient::available()
+{
+    int bytes = 0;
+    if (_fd < 0 || ioctl(_fd, FIONREAD, &bytes) != 0)
+    {
+        return 0;
+    }
+    return bytes;
+}
+
+int HostClient::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int HostClient::read(uint8_t *buffer, size_t size)
+{
+    if (_fd < 0)
+    {
+        return -1;
+    }
+    ssize_t received = recv(_fd, buffer, size, MSG_DONTWAIT);
+    return received > 0 ? received : -1;
+}
+
+int HostClient::peek()
+{
+    uint8_t c;
+    if (_fd < 0 || recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 1)
+    {
+        return -1;
+    }
+    return c;
+}
+
+void HostClient::flush()
+{
+}
+
+void HostClient::stop()
+{
+    if (_fd < 0)
+    {
+        return;
+    }
+
+    // Discards what the peer already sent, so the close is a FIN and not a reset that could
+    // destroy the response still in flight
+    shutdown(_fd, SHUT_WR);
+    uint8_t discard[512];
+    while (recv(_fd, discard, sizeof(discard), MSG_DONTWAIT) > 0)
+    {
+    }
+    close(_fd);
+    _fd = -1;
+}
+
+uint8_t HostClient::connected()
+{
+    if (_fd < 0 || _reset)
+    {
+        return 0;
+    }
+
+    // Like EthernetClient, still connected while there is data to read
+    uint8_t c;
+    ssize_t received = recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (received > 0)
+    {
+        return 1;
+    }
+    return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : 0;
+}
+
+HostClient::operator bool()
+{
+    return _fd >= 0;
+}
+
+IPAddress HostClient::remoteIP()
+{
+    struct sockaddr_in address = {};
+    socklen_t length = sizeof(address);
+    if (_fd < 0 || getpeername(_fd, (struct sockaddr *)&address, &length) != 0)
+    {
+        return IPAddress();
+    }
+    return IPAddress((uint32_t)address.sin_addr.s_addr); // Already in the byte order of IPAddress
+}
+
+int HostClient::fd()
+{
+    return _fd;
+}
+
+HostServer::HostServer(uint16_t port)
+{
+    _port = port;
+    _fd = -1;
+}
+
+bool HostServer::begin()
+{
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0)
+    {
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(_port);
+
+    if (bind(_fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(_fd, 128) != 0)
+    {
+        close(_fd);
+        _fd = -1;
+        return false;
+    }
+    return true;
+}
+
+HostClient HostServer::accept(uint32_t timeoutMs)
+{
+    struct pollfd pfd = {_fd, POLLIN, 0};
+    if (_fd < 0 || poll(&pfd, 1, timeoutMs) <= 0)
+    {
+        return HostClient();
+    }
+    return HostClient(::accept(_fd, NULL, NULL));
+}
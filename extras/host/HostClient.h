@@ -0,0 +1,59 @@
+#ifndef HOST_CLIENT_H
+#define HOST_CLIENT_H
+
+#include "Arduino.h"
+
+/**
+ * @class HostClient
+ * @brief TCP connection over a POSIX socket, with the behaviour of EthernetClient.
+ *
+ * Reads never block; writes block until the data is in the kernel buffer (the socket
+ * buffer plays the role of the W5500 TX buffer). Copies share the same socket.
+ */
+class HostClient : public Client
+{
+public:
+    HostClient();
+    HostClient(int fd);
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override;
+
+    IPAddress remoteIP();
+    int fd();
+
+private:
+    int _fd;
+    bool _reset;
+};
+
+/**
+ * @class HostServer
+ * @brief Listening socket, with the behaviour of EthernetServer.
+ */
+class HostServer
+{
+public:
+    HostServer(uint16_t port);
+
+    bool begin();
+    HostClient accept(uint32_t timeoutMs = 1000);
+
+private:
+    uint16_t _port;
+    int _fd;
+};
+
+#endif // HOST_CLIENT_H
@@ -0,0 +1,134 @@
+#include "HostClient.h"
+#include "FS.h"
+#include "RequestsAndResponses.h"
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Files up to this size leave with their headers in a single sendmsg() (a writev() that takes
+// MSG_NOSIGNAL) of the mapped file; larger files go through sendfile(), which maps nothing
+#define HOST_MMAP_MAX_SIZE (256 * 1024)
+
+// Waits until the socket accepts data; false when it did not within the timeout
+static bool waitWritable(int fd, uint32_t timeoutMs)
+{
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    return poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & (POLLERR | POLLHUP)) == 0;
+}
+
+// Sends the header block and the mapped body with as few sendmsg() calls as the socket allows
+static size_t sendMapped(int socketFd, const uint8_t *head, size_t headLength, const uint8_t *body, size_t size, uint32_t timeoutMs)
+{
+    struct iovec parts[2] = {{(void *)head, headLength}, {(void *)body, size}};
+    struct msghdr message = {};
+    message.msg_iov = headLength > 0 ? parts : parts + 1;
+    message.msg_iovlen = headLength > 0 ? 2 : 1;
+
+    size_t remaining = headLength + size;
+    while (remaining > 0)
+    {
+        ssize_t n = sendmsg(socketFd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0)
+        {
+            if (errno == EAGAIN && waitWritable(socketFd, timeoutMs))
+            {
+                continue;
+            }
+            break;
+        }
+
+        remaining -= n;
+        while (n > 0 && (size_t)n >= message.msg_iov->iov_len)
+        {
+            n -= message.msg_iov->iov_len;
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+        if (n > 0)
+        {
+            message.msg_iov->iov_base = (uint8_t *)message.msg_iov->iov_base + n;
+            message.msg_iov->iov_len -= n;
+        }
+    }
+
+    size_t sent = headLength + size - remaining;
+    return sent > headLength ? sent - headLength : 0;
+}
+
+// Sends the header block (held back with MSG_MORE so it shares a segment with the body),
+// then the file with sendfile(), without copying it through user space
+static size_t sendWithSendfile(int socketFd, int fileFd, off_t offset, const uint8_t *head, size_t headLength, size_t size, uint32_t timeoutMs)
+{
+    while (headLength > 0)
+    {
+        ssize_t n = send(socketFd, head, headLength, MSG_NOSIGNAL | MSG_DONTWAIT | MSG_MORE);
+        if (n < 0)
+        {
+            if (errno == EAGAIN && waitWritable(socketFd, timeoutMs))
+            {
+                continue;
+            }
+            return 0;
+        }
+        head += n;
+        headLength -= n;
+    }
+
+    // sendfile() has no flags: the socket is made non-blocking for the transfer, so that a
+    // client that stops reading only holds the server for the timeout
+    int flags = fcntl(socketFd, F_GETFL);
+    fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+
+    size_t sent = 0;
+    while (sent < size)
+    {
+        ssize_t n = sendfile(socketFd, fileFd, &offset, size - sent);
+        if (n > 0)
+        {
+            sent += n;
+        }
+        else if (n == 0 || errno != EAGAIN || !waitWritable(socketFd, timeoutMs))
+        {
+            break; // End of file (truncated meanwhile), error or timeout
+        }
+    }
+
+    fcntl(socketFd, F_SETFL, flags);
+    return sent;
+}
+
+bool sendFileNative(Client &client, fs::File &file, const uint8_t *head, size_t headLength, size_t size, uint32_t timeoutMs, size_t *sent)
+{
+    // Only a HostClient is a socket; wrappers (e.g. ResponseCache::Recorder) need the copy
+    HostClient *host = dynamic_cast<HostClient *>(&client);
+    int fileFd = file.fd();
+    if (host == nullptr || host->fd() < 0 || fileFd < 0)
+    {
+        return false;
+    }
+
+    int socketFd = host->fd();
+    off_t offset = file.position();
+
+    if (size > 0 && size <= HOST_MMAP_MAX_SIZE)
+    {
+        // The mapping starts at the beginning of the page that holds the offset
+        off_t pageStart = offset & ~(off_t)(sysconf(_SC_PAGESIZE) - 1);
+        size_t mappedSize = size + (offset - pageStart);
+        void *mapped = mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE, fileFd, pageStart);
+        if (mapped != MAP_FAILED)
+        {
+            *sent = sendMapped(socketFd, head, headLength, (const uint8_t *)mapped + (offset - pageStart), size, timeoutMs);
+            munmap(mapped, mappedSize);
+            return true;
+        }
+    }
+
+    *sent = sendWithSendfile(socketFd, fileFd, offset, head, headLength, size, timeoutMs);
+    return true;
+}
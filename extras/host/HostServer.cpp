@@ -0,0 +1,396 @@
+/**
+ * @file HostServer.cpp
+ * @brief Linux build of the example servers, for load tests without hardware
+ *
+ * Serves the routes of the WebServer, WebServerCache and WebServerGzip examples with the
+ * library compiled for the host, one connection at a time like the sketches. Together with
+ * the LoadGenerator tool (extras/LoadGenerator) it gives reproducible throughput and latency
+ * numbers on localhost.
+ *
+ * Routes:
+ * - GET /test, GET /stats, POST /status-led, POST /settings (JSON), PUT and DELETE on any URL (WebServer)
+ * - GET /, /index.html (gzip on the fly), /assets/..., /version (WebServerCache)
+ * - GET /gzip/index.html, /gzip/assets/... (pre-compressed, WebServerGzip)
+ * - GET /status.html: page rendered from a PROGMEM template (ServerSentEvents)
+ * - GET /files/<path>: file of the directory given as second argument (files up to 64 KB
+ *   are kept in a FileCache, larger ones are read from the disk on every request)
+ *
+ * An optional third argument names a file where the access log of the requests is appended.
+ *
+ * Build and usage: see extras/README.md.
+ *
+ * @author Michel Galvão
+ * @see https://github.com/MicSG-dev
+ * @see https://github.com/MicSG-dev/RequestsAndResponses
+ * @contact contato@micsg.com.br
+ *
+ * @date Created: 2026-10-18
+ * @version 1.0.0
+ * @copyright MIT License
+ */
+
+#include "Arduino.h"
+#include "HostClient.h"
+#include "RequestsAndResponses.h"
+#include "web.h"
+#include "gzip.h"
+#include <signal.h>
+
+const char *VERSION_FIRMWARE = "0.0.1";
+const char CACHE_CONTROL[] = "public, max-age=2592000, immutable";
+
+GzipEncoder gzip; // Compressor shared by the responses
+
+static uint8_t filePool[256 * 1024];
+FileCache fileCache(filePool, sizeof(filePool), 64 * 1024); // Small files of /files
+
+const char STATUS_HTML[] PROGMEM = R"=====(<!DOCTYPE html>
+<html>
+<body>
+  <h1>Requests served: {{requests}}</h1>
+  <p>Up for {{uptime}} s, {{stalls}} clients dropped for not reading.</p>
+</body>
+</html>
+)=====";
+
+// Placeholders of STATUS_HTML, in the order of the ids received by the resolver
+const char *const STATUS_FIELDS[] = {"requests", "uptime", "stalls"};
+
+PageTemplate statusPage(STATUS_HTML, STATUS_FIELDS, 3);
+
+// Routes of the access log; the ones ending with a slash match every URL that starts with them
+const char *const ROUTES[] = {"/", "/test", "/stats", "/status-led", "/settings", "/index.html", "/version", "/status.html",
+                              "/assets/", "/gzip/", "/files/"};
+const uint8_t NUM_ROUTES = sizeof(ROUTES) / sizeof(ROUTES[0]);
+
+AccessLog accessLog;
+
+static volatile bool running = true;
+
+static void stopServer(int)
+{
+    running = false;
+}
+
+// Content type of the files served from /files
+static const char *contentTypeOf(const char *path)
+{
+    const char *extension = strrchr(path, '.');
+    if (extension == NULL)
+    {
+        return "application/octet-stream";
+    }
+    if (strcmp(extension, ".html") == 0)
+    {
+        return ContentType::TEXT_HTML;
+    }
+    if (strcmp(extension, ".css") == 0)
+    {
+        return ContentType::TEXT_CSS;
+    }
+    if (strcmp(extension, ".js") == 0)
+    {
+        return ContentType::TEXT_JAVASCRIPT;
+    }
+    if (strcmp(extension, ".json") == 0)
+    {
+        return ContentType::APPLICATION_JSON;
+    }
+    if (strcmp(extension, ".txt") == 0)
+    {
+        return ContentType::TEXT_PLAIN;
+    }
+    return "application/octet-stream";
+}
+
+// Static assets of the WebServerCache example
+static void sendAsset(Client &client, AnalyserRequest &request, const char *contentType, const char *content)
+{
+    BuildResponse response(client, request);
+    response.begin(StatusCode::Successful::_200_OK);
+    response.addHeader("Cache-Control", CACHE_CONTROL);
+    response.addHeader("ETag", VERSION_FIRMWARE);
+    response.send(contentType, content, strlen_P(content));
+}
+
+// Pre-compressed assets of the WebServerGzip example
+static void sendGzipAsset(Client &client, AnalyserRequest &request, const char *contentType, const uint8_t *content, uint32_t size)
+{
+    BuildResponse response(client, request);
+    response.begin(StatusCode::Successful::_200_OK);
+    response.send(contentType, content, size);
+}
+
+static void sendNotFound(Client &client, AnalyserRequest &request)
+{
+    BuildResponse response(client, request);
+    response.begin(StatusCode::ClientError::_404_NOT_FOUND);
+    response.send(ContentType::TEXT_PLAIN, "URL not found");
+}
+
+static void handleGet(Client &client, AnalyserRequest &request, fs::FS &files)
+{
+    const char *url = request.getUrl();
+
+    if (request.urlIs("/test"))
+    {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_PLAIN, "URL '/test' detected");
+    }
+    else if (request.urlIs("/stats"))
+    {
+        ConnectionStats stats = RequestReader::getStats();
+        char json[192];
+        snprintf(json, sizeof(json),
+                 "{\"requests\":%u,\"timeouts\":%u,\"writeStalls\":%u,\"closedEarly\":%u,\"oversized\":%u,\"malformed\":%u}",
+                 (unsigned)stats.requests,
+                 (unsigned)(stats.requestLineTimeouts + stats.headerTimeouts + stats.bodyTimeouts + stats.totalTimeouts),
+                 (unsigned)stats.writeStalls, (unsigned)stats.closedEarly, (unsigned)stats.oversized, (unsigned)stats.malformed);
+
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::APPLICATION_JSON, json);
+    }
+    else if (request.urlIs("/"))
+    {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Redirection::_302_FOUND);
+        response.addHeader("Location", "/index.html");
+        response.send();
+    }
+    else if (request.urlIs("/index.html"))
+    {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.enableCompression(gzip, request); // Compressed on the fly when the client accepts gzip
+        response.addHeader("Cache-Control", CACHE_CONTROL);
+        response.addHeader("ETag", VERSION_FIRMWARE);
+        response.send(ContentType::TEXT_HTML, INDEX_HTML, strlen_P(INDEX_HTML));
+    }
+    else if (request.urlIs("/assets/bootstrap/css/bootstrap.min.css"))
+    {
+        sendAsset(client, request, ContentType::TEXT_CSS, BOOTSTRAP_MIN_CSS);
+    }
+    else if (request.urlIs("/assets/bootstrap/js/bootstrap.min.js"))
+    {
+        sendAsset(client, request, ContentType::TEXT_JAVASCRIPT, BOOTSTRAP_MIN_JS);
+    }
+    else if (request.urlIs("/assets/js/script.js"))
+    {
+        sendAsset(client, request, ContentType::TEXT_JAVASCRIPT, SCRIPT_JS);
+    }
+    else if (request.urlIs("/version"))
+    {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_PLAIN, VERSION_FIRMWARE);
+    }
+    else if (request.urlIs("/status.html"))
+    {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_HTML, statusPage, [](uint8_t id, Print &output)
+                      {
+                          if (id == 0)
+                          {
+                              output.print(RequestReader::getStats().requests);
+                          }
+                          else if (id == 1)
+                          {
+                              output.print(millis() / 1000);
+                          }
+                          else
+                          {
+                              output.print(BuildResponse::getWriteStalls());
+                          } });
+    }
+    else if (request.urlIs("/gzip/index.html"))
+    {
+        sendGzipAsset(client, request, ContentType::TEXT_HTML, web_gzip::_INDEX_HTML::content, web_gzip::_INDEX_HTML::size);
+    }
+    else if (request.urlIs("/gzip/assets/bootstrap/css/bootstrap.min.css"))
+    {
+        sendGzipAsset(client, request, ContentType::TEXT_CSS, web_gzip::_ASSETS_BOOTSTRAP_CSS_BOOTSTRAP_MIN_CSS::content,
+                      web_gzip::_ASSETS_BOOTSTRAP_CSS_BOOTSTRAP_MIN_CSS::size);
+    }
+    else if (request.urlIs("/gzip/assets/bootstrap/js/bootstrap.min.js"))
+    {
+        sendGzipAsset(client, request, ContentType::TEXT_JAVASCRIPT, web_gzip::_ASSETS_BOOTSTRAP_JS_BOOTSTRAP_MIN_JS::content,
+                      web_gzip::_ASSETS_BOOTSTRAP_JS_BOOTSTRAP_MIN_JS::size);
+    }
+    else if (strncmp(url, "/files/", 7) == 0 && strstr(url, "..") == NULL)
+    {
+        const char *path = url + 6; // Keeps the slash: "/files/big.bin" is "<directory>/big.bin"
+        if (files.exists(path))
+        {
+            BuildResponse response(client, request);
+            response.begin(StatusCode::Successful::_200_OK);
+            response.send(contentTypeOf(path), fileCache, files, path);
+        }
+        else
+        {
+            sendNotFound(client, request);
+        }
+    }
+    else
+    {
+        sendNotFound(client, request);
+    }
+}
+
+static uint8_t routeOf(const char *url)
+{
+    for (uint8_t i = 0; i < NUM_ROUTES; i++)
+    {
+        size_t length = strlen(ROUTES[i]);
+        bool prefix = length > 1 && ROUTES[i][length - 1] == '/';
+        if (prefix ? strncmp(url, ROUTES[i], length) == 0 : strcmp(url, ROUTES[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return AccessLog::NO_ROUTE;
+}
+
+static void handle(Client &client, AnalyserRequest &request, RequestReader &reader, fs::FS &files)
+{
+    if (request.methodIs(MethodsHttp::GET) || request.methodIs(MethodsHttp::HEAD))
+    {
+        handleGet(client, request, files);
+    }
+    else if (request.methodIs(MethodsHttp::POST))
+    {
+        if (request.urlIs("/status-led"))
+        {
+            uint8_t body[64];
+            while (reader.readBody(body, sizeof(body)) > 0)
+            {
+            }
+            if (reader.getResult() != RequestReader::READY)
+            {
+                return; // Already answered by the reader (408) or the client left
+            }
+
+            BuildResponse response(client, request);
+            response.begin(StatusCode::Successful::_200_OK);
+            response.send(ContentType::TEXT_PLAIN, "LED status changed successfully!");
+        }
+        else if (request.urlIs("/settings"))
+        {
+            char name[33] = "";
+            bool ledOn = false;
+            int brightness = 0;
+
+            JsonParser parser;
+            parser.bind("name", name, sizeof(name));
+            parser.bind("led.on", ledOn);
+            parser.bind("led.brightness", brightness);
+
+            JsonParser::Status status = parser.parseBody(reader);
+            if (status == JsonParser::DONE)
+            {
+                char json[96];
+                snprintf(json, sizeof(json), "{\"name\":\"%s\",\"led\":{\"on\":%s,\"brightness\":%d}}",
+                         name, ledOn ? "true" : "false", brightness);
+
+                BuildResponse response(client, request);
+                response.begin(StatusCode::Successful::_200_OK);
+                response.send(ContentType::APPLICATION_JSON, json);
+            }
+            else if (status != JsonParser::BODY_STOPPED) // A body that stopped coming was already answered by the reader (e.g. 408)
+            {
+                BuildResponse response(client, request);
+                response.begin(StatusCode::ClientError::_400_BAD_REQUEST);
+                response.send(ContentType::TEXT_PLAIN, "Invalid JSON");
+            }
+        }
+        else
+        {
+            sendNotFound(client, request);
+        }
+    }
+    else if (request.methodIs(MethodsHttp::PUT) || request.methodIs(MethodsHttp::DELETE))
+    {
+        char message[32];
+        snprintf(message, sizeof(message), "%s method detected", request.getMethod());
+
+        BuildResponse response(client, request);
+        response.begin(StatusCode::Successful::_200_OK);
+        response.send(ContentType::TEXT_PLAIN, message);
+    }
+    else
+    {
+        BuildResponse response(client, request);
+        response.begin(StatusCode::ClientError::_405_METHOD_NOT_ALLOWED);
+        response.send(ContentType::TEXT_PLAIN, "Method not allowed");
+    }
+}
+
+static bool serve(Client &client, AnalyserRequest &request, fs::FS &files)
+{
+    RequestReader reader(client, request);
+    if (reader.read() != RequestReader::READY)
+    {
+        return false;
+    }
+    handle(client, request, reader, files);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    uint16_t port = argc > 1 ? atoi(argv[1]) : 8080;
+    fs::FS files(argc > 2 ? argv[2] : ".");
+
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+
+    HostServer server(port);
+    if (!server.begin())
+    {
+        fprintf(stderr, "Unable to listen on port %u\n", port);
+        return 1;
+    }
+    printf("Listening on port %u\n", port);
+
+    fs::FS root("");
+    File logFile;
+    if (argc > 3)
+    {
+        accessLog.setRoutes(ROUTES, NUM_ROUTES);
+        logFile = root.open(argv[3], "a");
+    }
+
+    uint32_t served = 0;
+    while (running)
+    {
+        HostClient client = server.accept();
+        if (!client)
+        {
+            continue;
+        }
+
+        AnalyserRequest request;
+        if (logFile)
+        {
+            // The record is added to the log when the recorder goes out of scope
+            AccessLog::Recorder logged(accessLog, client, request, client.remoteIP());
+            served += serve(logged, request, files);
+            logged.setRoute(routeOf(request.getUrl()));
+        }
+        else
+        {
+            served += serve(client, request, files);
+        }
+        client.stop();
+
+        accessLog.drain(logFile);
+        logFile.flush();
+    }
+
+    ConnectionStats stats = RequestReader::getStats();
+    printf("\n%u requests served, %u write stalls, %u closed early, %u log records dropped\n", (unsigned)served,
+           (unsigned)stats.writeStalls, (unsigned)stats.closedEarly, (unsigned)accessLog.getDropped());
+    return 0;
+}
@@ -0,0 +1,318 @@
+#include "AccessLog.h"
+
+static_assert((ACCESS_LOG_SIZE & (ACCESS_LOG_SIZE - 1)) == 0, "ACCESS_LOG_SIZE must be a power of two");
+
+AccessLog::AccessLog()
+{
+    _head = 0;
+    _tail = 0;
+    _routes = nullptr;
+    _numRoutes = 0;
+    _logged = 0;
+    _dropped = 0;
+#if defined(ESP32)
+    _taskOutput = nullptr;
+    _taskPeriodMs = 0;
+#endif
+}
+
+void AccessLog::setRoutes(const char *const *names, uint8_t count)
+{
+    _routes = names;
+    _numRoutes = count;
+}
+
+bool AccessLog::log(const AccessRecord &record)
+{
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= ACCESS_LOG_SIZE)
+    {
+        _dropped++; // Full: the request is not kept waiting for the output
+        return false;
+    }
+
+    _records[head % ACCESS_LOG_SIZE] = record;
+    _head.store(head + 1, std::memory_order_release); // Publishes the record to the consumer
+    _logged++;
+    return true;
+}
+
+bool AccessLog::read(AccessRecord &record)
+{
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    record = _records[tail % ACCESS_LOG_SIZE];
+    _tail.store(tail + 1, std::memory_order_release); // Gives the slot back to the producer
+    return true;
+}
+
+size_t AccessLog::format(const AccessRecord &record, char *line, size_t size)
+{
+    char route[8];
+    const char *routeName = route;
+    if (record.route < _numRoutes)
+    {
+        routeName = _routes[record.route];
+    }
+    else if (record.route == NO_ROUTE)
+    {
+        routeName = "-";
+    }
+    else
+    {
+        snprintf(route, sizeof(route), "#%u", record.route);
+    }
+
+    IPAddress ip(record.ip);
+    int len = snprintf(line, size, "%lu %u.%u.%u.%u %s %s %u %lu %lu.%03lums\r\n",
+                       (unsigned long)record.timestamp, ip[0], ip[1], ip[2], ip[3],
+                       record.method[0] != '\0' ? record.method : "-", routeName, record.status,
+                       (unsigned long)record.bytes, (unsigned long)(record.durationUs / 1000),
+                       (unsigned long)(record.durationUs % 1000));
+    if (len < 0)
+    {
+        return 0;
+    }
+    return (size_t)len < size ? len : size - 1;
+}
+
+size_t AccessLog::drain(Print &output, size_t maxRecords)
+{
+    AccessRecord record;
+    size_t count = 0;
+    while (count < maxRecords && read(record))
+    {
+        char line[96];
+        output.write((const uint8_t *)line, format(record, line, sizeof(line)));
+        count++;
+    }
+    return count;
+}
+
+size_t AccessLog::drain(fs::FS &fs, const char *path, size_t maxRecords)
+{
+    // The file is only opened when there is something to write
+    if (_tail.load(std::memory_order_relaxed) == _head.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    File file = fs.open(path, "a");
+    if (!file)
+    {
+        return 0;
+    }
+    size_t count = drain(file, maxRecords);
+    file.close();
+    return count;
+}
+
+size_t AccessLog::drain(UDP &udp, IPAddress host, uint16_t port, size_t maxRecords)
+{
+    AccessRecord record;
+    size_t count = 0;
+    size_t packetLength = 0;
+    while (count < maxRecords && read(record))
+    {
+        char line[96];
+        size_t len = format(record, line, sizeof(line));
+
+        // As many lines per packet as fit in ACCESS_LOG_PACKET_SIZE
+        if (packetLength > 0 && packetLength + len > ACCESS_LOG_PACKET_SIZE)
+        {
+            udp.endPacket();
+            packetLength = 0;
+        }
+        if (packetLength == 0)
+        {
+            udp.beginPacket(host, port);
+        }
+        udp.write((const uint8_t *)line, len);
+        packetLength += len;
+        count++;
+    }
+
+    if (packetLength > 0)
+    {
+        udp.endPacket();
+    }
+    return count;
+}
+
+#if defined(ESP32)
+void AccessLog::drainTask(void *parameter)
+{
+    AccessLog *log = (AccessLog *)parameter;
+    while (true)
+    {
+        log->drain(*log->_taskOutput);
+        vTaskDelay(pdMS_TO_TICKS(log->_taskPeriodMs));
+    }
+}
+
+bool AccessLog::beginTask(Print &output, uint32_t periodMs)
+{
+    if (_taskOutput != nullptr)
+    {
+        return false; // Only one consumer
+    }
+
+    _taskOutput = &output;
+    _taskPeriodMs = periodMs > 0 ? periodMs : 1;
+    if (xTaskCreate(drainTask, "accessLog", ACCESS_LOG_TASK_STACK_SIZE, this, tskIDLE_PRIORITY + 1, NULL) != pdPASS)
+    {
+        _taskOutput = nullptr;
+        return false;
+    }
+    return true;
+}
+#endif
+
+uint32_t AccessLog::getLogged()
+{
+    return _logged;
+}
+
+uint32_t AccessLog::getDropped()
+{
+    return _dropped;
+}
+
+AccessLog::Recorder::Recorder(AccessLog &log, Client &client, AnalyserRequest &request, IPAddress ip)
+{
+    _log = &log;
+    _client = &client;
+    _request = &request;
+    _startUs = micros();
+    _statusLength = 0;
+    _committed = false;
+
+    memset(&_record, 0, sizeof(_record));
+    _record.timestamp = millis();
+    _record.ip = (uint32_t)ip;
+    _record.route = NO_ROUTE;
+}
+
+AccessLog::Recorder::~Recorder()
+{
+    commit();
+}
+
+void AccessLog::Recorder::setRoute(uint8_t route)
+{
+    _record.route = route;
+}
+
+bool AccessLog::Recorder::commit()
+{
+    if (_committed)
+    {
+        return false;
+    }
+    _committed = true;
+
+    // "HTTP/1.1 200 OK": the status code follows the first space
+    if (_statusLength == sizeof(_statusLine) && memcmp(_statusLine, "HTTP/", 5) == 0)
+    {
+        const char *space = (const char *)memchr(_statusLine, ' ', sizeof(_statusLine));
+        if (space != nullptr && space + 4 <= _statusLine + sizeof(_statusLine))
+        {
+            _record.status = (space[1] - '0') * 100 + (space[2] - '0') * 10 + (space[3] - '0');
+        }
+    }
+
+    strncpy(_record.method, _request->getMethod(), sizeof(_record.method) - 1);
+    _record.method[sizeof(_record.method) - 1] = '\0';
+    _record.durationUs = micros() - _startUs;
+    return _log->log(_record);
+}
+
+size_t AccessLog::Recorder::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+size_t AccessLog::Recorder::write(const uint8_t *buffer, size_t size)
+{
+    // Only what the client accepted is kept: the rest is written again by the caller
+    size_t written = _client->write(buffer, size);
+    _record.bytes += written;
+
+    // Keeps the beginning of the status line, to read the status code when committing; an
+    // interim response (e.g. "100 Continue") is replaced by the response that follows it
+    if (_statusLength == sizeof(_statusLine) && _statusLine[9] == '1' && written >= 5 && memcmp(buffer, "HTTP/", 5) == 0)
+    {
+        _statusLength = 0;
+    }
+    if (_statusLength < sizeof(_statusLine))
+    {
+        size_t n = sizeof(_statusLine) - _statusLength;
+        if (n > written)
+        {
+            n = written;
+        }
+        memcpy(_statusLine + _statusLength, buffer, n);
+        _statusLength += n;
+    }
+
+    return written;
+}
+
+int AccessLog::Recorder::availableForWrite()
+{
+    return _client->availableForWrite();
+}
+
+int AccessLog::Recorder::connect(IPAddress ip, uint16_t port)
+{
+    return _client->connect(ip, port);
+}
+
+int AccessLog::Recorder::connect(const char *host, uint16_t port)
+{
+    return _client->connect(host, port);
+}
+
+int AccessLog::Recorder::available()
+{
+    return _client->available();
+}
+
+int AccessLog::Recorder::read()
+{
+    return _client->read();
+}
+
+int AccessLog::Recorder::read(uint8_t *buffer, size_t size)
+{
+    return _client->read(buffer, size);
+}
+
+int AccessLog::Recorder::peek()
+{
+    return _client->peek();
+}
+
+void AccessLog::Recorder::flush()
+{
+    _client->flush();
+}
+
+void AccessLog::Recorder::stop()
+{
+    _client->stop();
+}
+
+uint8_t AccessLog::Recorder::connected()
+{
+    return _client->connected();
+}
+
+AccessLog::Recorder::operator bool()
+{
+    return (bool)*_client;
+}
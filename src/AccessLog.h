@@ -0,0 +1,160 @@
+#ifndef ACCESS_LOG_H
+#define ACCESS_LOG_H
+
+#include "RequestsAndResponses.h"
+#include <Udp.h>
+#include <atomic>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+/**
+ * @brief Number of records an AccessLog holds before new ones are dropped (a power of two).
+ */
+#ifndef ACCESS_LOG_SIZE
+#define ACCESS_LOG_SIZE 32
+#endif
+
+/**
+ * @brief Maximum size (in bytes) of a UDP packet sent by AccessLog::drain().
+ */
+#ifndef ACCESS_LOG_PACKET_SIZE
+#define ACCESS_LOG_PACKET_SIZE 1024
+#endif
+
+/**
+ * @brief Stack size (in bytes) of the task started by AccessLog::beginTask() (ESP32 only).
+ */
+#ifndef ACCESS_LOG_TASK_STACK_SIZE
+#define ACCESS_LOG_TASK_STACK_SIZE 3072
+#endif
+
+/**
+ * @brief Access log entry of a request.
+ *
+ * The timestamp is the value of millis() when the request started and the duration runs
+ * until the end of its response. bytes counts everything sent to the client (status line,
+ * headers and body); status is 0 when nothing was sent, method is empty when the request line
+ * was not received and route is AccessLog::NO_ROUTE when the sketch did not set one.
+ */
+struct AccessRecord
+{
+    uint32_t timestamp;
+    uint32_t durationUs;
+    uint32_t bytes;
+    uint32_t ip;
+    uint16_t status;
+    uint8_t route;
+    char method[9];
+};
+
+/**
+ * @class AccessLog
+ * @brief Access log that never makes the request path wait for its output.
+ *
+ * The request path adds a fixed-size record per request to a lock-free ring buffer; the
+ * records are written to their output later, by drain(), one line each:
+ *
+ *     <timestamp> <ip> <method> <route> <status> <bytes> <duration>ms
+ *
+ * drain() writes to any Print (e.g. Serial), appends to a file or sends UDP packets. It is
+ * called from loop() when there is nothing else to do or, on the ESP32, from a task of low
+ * priority started by beginTask(). When the ring is full, new records are dropped and
+ * counted (getDropped()), so a slow output never slows down the server.
+ *
+ * There must be a single producer (the code that serves the requests) and a single consumer
+ * (whoever calls drain() or read()), which may run on different cores.
+ *
+ * The Recorder wraps the client of a request and fills the record with what passes through
+ * it: the status code of the response and the number of bytes sent.
+ *
+ * Usage:
+ * @code
+ * AccessLog::Recorder logged(accessLog, client, request, client.remoteIP());
+ * RequestReader reader(logged, request);
+ * ...
+ * BuildResponse response(logged, request);
+ * @endcode
+ */
+class AccessLog
+{
+public:
+    static const uint8_t NO_ROUTE = 0xFF;
+
+    /**
+     * @class Recorder
+     * @brief Client wrapper that counts a response and adds its record to the log when it is destroyed.
+     */
+    class Recorder : public Client
+    {
+    public:
+        Recorder(AccessLog &log, Client &client, AnalyserRequest &request, IPAddress ip);
+        ~Recorder();
+
+        void setRoute(uint8_t route);
+        bool commit();
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(const char *host, uint16_t port) override;
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        int availableForWrite() override;
+        int available() override;
+        int read() override;
+        int read(uint8_t *buffer, size_t size) override;
+        int peek() override;
+        void flush() override;
+        void stop() override;
+        uint8_t connected() override;
+        operator bool() override;
+
+    private:
+        AccessLog *_log;
+        Client *_client;
+        AnalyserRequest *_request;
+        AccessRecord _record;
+        uint32_t _startUs;
+        char _statusLine[12];
+        uint8_t _statusLength;
+        bool _committed;
+    };
+
+    AccessLog();
+
+    void setRoutes(const char *const *names, uint8_t count);
+    bool log(const AccessRecord &record);
+    bool read(AccessRecord &record);
+
+    size_t format(const AccessRecord &record, char *line, size_t size);
+    size_t drain(Print &output, size_t maxRecords = ACCESS_LOG_SIZE);
+    size_t drain(fs::FS &fs, const char *path, size_t maxRecords = ACCESS_LOG_SIZE);
+    size_t drain(UDP &udp, IPAddress host, uint16_t port, size_t maxRecords = ACCESS_LOG_SIZE);
+#if defined(ESP32)
+    bool beginTask(Print &output, uint32_t periodMs = 100);
+#endif
+
+    uint32_t getLogged();
+    uint32_t getDropped();
+
+private:
+#if defined(ESP32)
+    static void drainTask(void *parameter);
+
+    Print *_taskOutput;
+    uint32_t _taskPeriodMs;
+#endif
+
+    AccessRecord _records[ACCESS_LOG_SIZE];
+    std::atomic<uint32_t> _head; // Next record to write, only changed by the producer
+    std::atomic<uint32_t> _tail; // Next record to read, only changed by the consumer
+
+    const char *const *_routes;
+    uint8_t _numRoutes;
+
+    std::atomic<uint32_t> _logged;
+    std::atomic<uint32_t> _dropped;
+};
+
+#endif // ACCESS_LOG_H
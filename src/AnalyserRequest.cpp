@@ -1,4 +1,5 @@
 #include "RequestsAndResponses.h"
+#include "ByteScan.h"
 
 AnalyserRequest::AnalyserRequest()
 {
@@ -6,89 +7,132 @@ AnalyserRequest::AnalyserRequest()
     _haveParameters = false;
     _numHeadersCustom = 0;
     _method = MethodsHttp::UNKNOWN;
+    _requestLineParsed = false;
+    _malformed = false;
+    _httpMinorVersion = 1;
+    _webSocketVersion = 0;
+    _expectContinue = false;
+    _url[0] = '\0';
+    _params = NULL;
 }
 
-Header AnalyserRequest::analyzeHttpLine(const char *line)
+// Packs up to 8 characters into a word, first character in the least significant byte
+static constexpr uint64_t packWord(const char *text, size_t i = 0)
 {
-    if (_method == MethodsHttp::UNKNOWN && strncmp(line, "POST", 4) == 0)
-    {
-        _method = MethodsHttp::POST;
+    return text[i] == '\0' || i == 8 ? 0 : ((uint64_t)(uint8_t)text[i] << (8 * i)) | packWord(text, i + 1);
+}
 
-        // Extract the URL from the request
-        char *urlStart = strstr(line, " ") + 1;
-        char *urlEnd = strchr(urlStart, ' ');
-        strncpy(_url, urlStart, urlEnd - urlStart);
-        _url[urlEnd - urlStart] = '\0'; // Finalize the string
+// Mask selecting the first `length` bytes of a packed word
+static constexpr uint64_t wordMask(size_t length)
+{
+    return length >= 8 ? ~(uint64_t)0 : (((uint64_t)1 << (8 * length)) - 1);
+}
 
-        // Remove the trailing slash if present
-        int len = strlen(_url);
-        if (len > 1 && _url[len - 1] == '/')
-        {
-            _url[len - 1] = '\0';
-        }
-    }
-    else if (_method == MethodsHttp::UNKNOWN && strncmp(line, "GET", 3) == 0)
+struct MethodToken
+{
+    uint64_t word;
+    uint8_t length; // Including the space that follows the method
+    MethodsHttp method;
+};
+
+static const MethodToken METHOD_TOKENS[] = {
+    {packWord("GET "), 4, MethodsHttp::GET},
+    {packWord("POST "), 5, MethodsHttp::POST},
+    {packWord("PUT "), 4, MethodsHttp::PUT},
+    {packWord("DELETE "), 7, MethodsHttp::DELETE},
+    {packWord("HEAD "), 5, MethodsHttp::HEAD},
+    {packWord("OPTIONS "), 8, MethodsHttp::OPTIONS},
+    {packWord("PATCH "), 6, MethodsHttp::PATCH},
+};
+
+bool AnalyserRequest::parseRequestLine(const char *line)
+{
+    // Identify the method by comparing the first bytes of the line as a single word
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8 && line[i] != '\0'; i++)
     {
-        _method = MethodsHttp::GET;
-
-        // Extract the URL from the request
-        char *urlStart = strstr(line, " ") + 1;
-        char *urlEnd = strchr(urlStart, ' ');
-        strncpy(_url, urlStart, urlEnd - urlStart);
-        _url[urlEnd - urlStart] = '\0'; // Finalize the string
+        word |= (uint64_t)(uint8_t)line[i] << (8 * i);
+    }
 
-        // Remove the trailing slash if present
-        int len = strlen(_url);
-        if (len > 1 && _url[len - 1] == '/')
+    const char *cursor = NULL;
+    for (size_t i = 0; i < sizeof(METHOD_TOKENS) / sizeof(METHOD_TOKENS[0]); i++)
+    {
+        if ((word & wordMask(METHOD_TOKENS[i].length)) == METHOD_TOKENS[i].word)
         {
-            _url[len - 1] = '\0';
+            _method = METHOD_TOKENS[i].method;
+            cursor = line + METHOD_TOKENS[i].length;
+            break;
         }
+    }
+    if (cursor == NULL)
+    {
+        return false; // Unknown method
+    }
 
-        // Check if the URL contains parameters
-        char *paramsStart = strchr(_url, '?');
-
-        if (paramsStart != NULL)
-        {
-            // Separate the URL from the parameters
-            *paramsStart = '\0'; // End URL before '?'
+    // The path ends at '?' or ' ', the query at ' '
+    const char *pathStart = cursor;
+    const char *queryStart = NULL;
+    size_t remaining = strlen(cursor);
+    cursor += scanBytes(cursor, remaining, " ?");
+    if (*cursor == '?')
+    {
+        queryStart = cursor;
+        cursor += scanBytes(cursor, remaining - (cursor - pathStart), " ");
+    }
+    const char *targetEnd = cursor;
 
-            // Extract the parameters (after '?')
-            _params = paramsStart + 1;
-            _haveParameters = true;
-        }
+    size_t targetLen = targetEnd - pathStart;
+    if (targetLen == 0 || targetLen >= sizeof(_url) || *cursor != ' ')
+    {
+        return false; // Empty or too long target, or missing HTTP version
     }
-    else if (_method == MethodsHttp::UNKNOWN && strncmp(line, "PUT", 3) == 0)
+
+    // Protocol version: only HTTP/1.x is accepted, and nothing may follow it (e.g. "HTTP/1.1 extra")
+    cursor++;
+    if (strncmp(cursor, "HTTP/1.", 7) != 0 || cursor[7] < '0' || cursor[7] > '9' ||
+        (cursor[8] != '\0' && (cursor[8] != '\r' || cursor[9] != '\0')))
     {
-        _method = MethodsHttp::PUT;
+        return false;
+    }
+    _httpMinorVersion = cursor[7] - '0';
 
-        // Extract the URL from the request
-        char *urlStart = strstr(line, " ") + 1;
-        char *urlEnd = strchr(urlStart, ' ');
-        strncpy(_url, urlStart, urlEnd - urlStart);
-        _url[urlEnd - urlStart] = '\0'; // Finalize the string
+    // Copy the target, separating the path from the parameters
+    memcpy(_url, pathStart, targetLen);
+    _url[targetLen] = '\0';
 
-        // Remove the trailing slash, if it exists
-        int len = strlen(_url);
-        if (len > 1 && _url[len - 1] == '/')
-        {
-            _url[len - 1] = '\0';
-        }
+    size_t pathLen = targetLen;
+    if (queryStart != NULL)
+    {
+        pathLen = queryStart - pathStart;
+        _url[pathLen] = '\0'; // End URL before '?'
+        _params = _url + pathLen + 1;
+        _haveParameters = true;
     }
-    else if (_method == MethodsHttp::UNKNOWN && strncmp(line, "DELETE", 6) == 0)
+
+    // Remove the trailing slash if present
+    if (pathLen > 1 && _url[pathLen - 1] == '/')
     {
-        _method = MethodsHttp::DELETE;
+        _url[pathLen - 1] = '\0';
+    }
 
-        // Extract the URL from the request
-        char *urlStart = strstr(line, " ") + 1;
-        char *urlEnd = strchr(urlStart, ' ');
-        strncpy(_url, urlStart, urlEnd - urlStart);
-        _url[urlEnd - urlStart] = '\0'; // Finalize the string
+    return true;
+}
 
-        // Remove the trailing slash if exists
-        int len = strlen(_url);
-        if (len > 1 && _url[len - 1] == '/')
+Header AnalyserRequest::analyzeHttpLine(const char *line)
+{
+    if (!_requestLineParsed)
+    {
+        // Empty lines before the request line are ignored (RFC 9112, section 2.2)
+        if (line[0] != '\0')
         {
-            _url[len - 1] = '\0';
+            _requestLineParsed = true;
+            if (!parseRequestLine(line))
+            {
+                _method = MethodsHttp::UNKNOWN;
+                _url[0] = '\0';
+                _haveParameters = false;
+                _malformed = true;
+            }
         }
     }
     else if (strncmp(line, "Content-Length: ", 16) == 0)
@@ -97,36 +141,97 @@ Header AnalyserRequest::analyzeHttpLine(const char *line)
     }
     else if (strncmp(line, "Content-Type: ", 14) == 0)
     {
-        strncpy(_contentType, line + 14, sizeof(_contentType));
+        strncpy(_contentType, line + 14, sizeof(_contentType) - 1);
+        _contentType[sizeof(_contentType) - 1] = '\0';
     }
     else if (strncmp(line, "Host: ", 6) == 0)
     {
-        strncpy(_host, line + 6, sizeof(_host));
+        strncpy(_host, line + 6, sizeof(_host) - 1);
+        _host[sizeof(_host) - 1] = '\0';
     }
     else if (strncmp(line, "User-Agent: ", 12) == 0)
     {
-        strncpy(_userAgent, line + 12, sizeof(_userAgent));
+        strncpy(_userAgent, line + 12, sizeof(_userAgent) - 1);
+        _userAgent[sizeof(_userAgent) - 1] = '\0';
     }
     else if (strncmp(line, "Authorization: ", 15) == 0)
     {
-        strncpy(_authorization, line + 15, sizeof(_authorization));
+        strncpy(_authorization, line + 15, sizeof(_authorization) - 1);
+        _authorization[sizeof(_authorization) - 1] = '\0';
     }
     else if (strncmp(line, "Cookie: ", 8) == 0)
     {
-        strncpy(_cookie, line + 8, sizeof(_cookie));
+        strncpy(_cookie, line + 8, sizeof(_cookie) - 1);
+        _cookie[sizeof(_cookie) - 1] = '\0';
+    }
+    else if (strncmp(line, "Upgrade: ", 9) == 0)
+    {
+        strncpy(_upgrade, line + 9, sizeof(_upgrade) - 1);
+        _upgrade[sizeof(_upgrade) - 1] = '\0';
+    }
+    else if (strncmp(line, "Connection: ", 12) == 0)
+    {
+        strncpy(_connection, line + 12, sizeof(_connection) - 1);
+        _connection[sizeof(_connection) - 1] = '\0';
+    }
+    else if (strncmp(line, "Sec-WebSocket-Key: ", 19) == 0)
+    {
+        strncpy(_webSocketKey, line + 19, sizeof(_webSocketKey) - 1);
+        _webSocketKey[sizeof(_webSocketKey) - 1] = '\0';
+    }
+    else if (strncmp(line, "Sec-WebSocket-Version: ", 23) == 0)
+    {
+        _webSocketVersion = atoi(line + 23);
+    }
+    else if (strncmp(line, "Last-Event-ID: ", 15) == 0)
+    {
+        strncpy(_lastEventId, line + 15, sizeof(_lastEventId) - 1);
+        _lastEventId[sizeof(_lastEventId) - 1] = '\0';
+    }
+    else if (strncmp(line, "Expect: ", 8) == 0)
+    {
+        _expectContinue = strcasecmp(line + 8, "100-continue") == 0;
+    }
+    else if (strncmp(line, "Content-Digest: ", 16) == 0 || strncmp(line, "Repr-Digest: ", 13) == 0 ||
+             strncmp(line, "Digest: ", 8) == 0 || strncmp(line, "X-SHA256: ", 10) == 0)
+    {
+        const char *value = strchr(line, ':') + 2;
+        strncpy(_contentDigest, value, sizeof(_contentDigest) - 1);
+        _contentDigest[sizeof(_contentDigest) - 1] = '\0';
+    }
+    else if (strncmp(line, "If-None-Match: ", 15) == 0)
+    {
+        strncpy(_ifNoneMatch, line + 15, sizeof(_ifNoneMatch) - 1);
+        _ifNoneMatch[sizeof(_ifNoneMatch) - 1] = '\0';
+    }
+    else if (strncmp(line, "Accept-Encoding: ", 17) == 0)
+    {
+        strncpy(_acceptEncoding, line + 17, sizeof(_acceptEncoding) - 1);
+        _acceptEncoding[sizeof(_acceptEncoding) - 1] = '\0';
     }
     else
     {
         
         Header headerCustom;
         
-        char *pos = strstr(line, ": "); // Find the position of ": " in the string
-        if (pos != NULL)
+        // Find the position of ": " in the string
+        size_t lineLen = strlen(line);
+        const char *pos = line + scanBytes(line, lineLen, ":");
+        while (*pos == ':' && pos[1] != ' ')
+        {
+            pos++;
+            pos += scanBytes(pos, lineLen - (pos - line), ":");
+        }
+        if (*pos == ':')
         {
             // Calculate the length of the part before ": "
             size_t chaveLen = pos - line;
+            if (chaveLen >= sizeof(headerCustom.key))
+            {
+                chaveLen = sizeof(headerCustom.key) - 1; // Longer keys are truncated
+            }
             // Copy the part before ": " to "key"
-            strncpy(headerCustom.key, line, chaveLen);
+            memcpy(headerCustom.key, line, chaveLen);
             headerCustom.key[chaveLen] = '\0'; // Ensures correct termination
 
             // Advance the position to after ": "
@@ -165,9 +270,9 @@ bool AnalyserRequest::methodIs(MethodsHttp method)
     return _method == method;
 }
 
-const char *AnalyserRequest::getMethod()
+const char *methodName(MethodsHttp method)
 {
-    switch (_method)
+    switch (method)
     {
     case MethodsHttp::GET:
         return "GET";
@@ -177,11 +282,37 @@ const char *AnalyserRequest::getMethod()
         return "DELETE";
     case MethodsHttp::PUT:
         return "PUT";
+    case MethodsHttp::HEAD:
+        return "HEAD";
+    case MethodsHttp::OPTIONS:
+        return "OPTIONS";
+    case MethodsHttp::PATCH:
+        return "PATCH";
     default:
         return "Unknown";
     }
 }
 
+const char *AnalyserRequest::getMethod()
+{
+    return methodName(_method);
+}
+
+bool AnalyserRequest::isMalformed()
+{
+    return _malformed;
+}
+
+const char *AnalyserRequest::getHttpVersion()
+{
+    return _httpMinorVersion == 0 ? "HTTP/1.0" : "HTTP/1.1";
+}
+
+bool AnalyserRequest::isHttp11()
+{
+    return _httpMinorVersion >= 1;
+}
+
 size_t AnalyserRequest::getContentLength()
 {
     return _contentLength;
@@ -196,23 +327,52 @@ const char *AnalyserRequest::getParams()
     return _params;
 }
 
-const char *AnalyserRequest::getParam(const char *param)
+// Finds the value of "name=value" in a list such as "a=1&b=2" or "a=1; b=2", comparing whole names
+static const char *findPair(const char *list, const char *name, const char *separator, size_t &valueLength)
 {
-    char *paramStart = strstr(_params, param);
+    size_t nameLength = strlen(name);
+    const char *end = list + strlen(list);
+    const char *item = list;
 
-    if (paramStart != NULL)
+    while (item < end)
     {
-        paramStart += strlen(param) + 1; // Skip the parameter name and the '='
-        char *paramEnd = strchr(paramStart, '&');
+        while (*item == ' ')
+        {
+            item++; // Cookies are separated by "; "
+        }
 
-        if (paramEnd == NULL)
+        size_t itemLength = scanBytes(item, end - item, separator);
+        if (itemLength >= nameLength && strncmp(item, name, nameLength) == 0 &&
+            (itemLength == nameLength || item[nameLength] == '='))
         {
-            paramEnd = _params + strlen(_params);
+            const char *value = itemLength > nameLength ? item + nameLength + 1 : item + nameLength;
+            valueLength = item + itemLength - value;
+            return value;
         }
+        item += itemLength + 1;
+    }
+    return NULL;
+}
 
+const char *AnalyserRequest::getParam(const char *param)
+{
+    if (!_haveParameters)
+    {
+        return NULL;
+    }
+
+    size_t valueLength;
+    const char *paramStart = findPair(_params, param, "&", valueLength);
+
+    if (paramStart != NULL)
+    {
         static char value[256];
-        strncpy(value, paramStart, paramEnd - paramStart);
-        value[paramEnd - paramStart] = '\0'; // Finalize the string
+        if (valueLength >= sizeof(value))
+        {
+            valueLength = sizeof(value) - 1;
+        }
+        memcpy(value, paramStart, valueLength);
+        value[valueLength] = '\0'; // Finalize the string
 
         return value;
     }
@@ -226,7 +386,8 @@ bool AnalyserRequest::paramExists(const char *param)
     {
         return false;
     }
-    return strstr(_params, param) != NULL;
+    size_t valueLength;
+    return findPair(_params, param, "&", valueLength) != NULL;
 }
 
 const char *AnalyserRequest::getContentType()
@@ -251,21 +412,18 @@ const char *AnalyserRequest::getAuthorization()
 
 const char *AnalyserRequest::getCookie(const char *cookie)
 {
-    char *cookieStart = strstr(_cookie, cookie);
+    size_t valueLength;
+    const char *cookieStart = findPair(_cookie, cookie, ";", valueLength);
 
     if (cookieStart != NULL)
     {
-        cookieStart += strlen(cookie) + 1; // Skip the cookie name and the '='
-        char *cookieEnd = strchr(cookieStart, ';');
-
-        if (cookieEnd == NULL)
+        static char value[256];
+        if (valueLength >= sizeof(value))
         {
-            cookieEnd = _cookie + strlen(_cookie);
+            valueLength = sizeof(value) - 1;
         }
-
-        static char value[256];
-        strncpy(value, cookieStart, cookieEnd - cookieStart);
-        value[cookieEnd - cookieStart] = '\0'; // Finalize the string
+        memcpy(value, cookieStart, valueLength);
+        value[valueLength] = '\0'; // Finalize the string
 
         return value;
     }
@@ -276,4 +434,90 @@ const char *AnalyserRequest::getCookie(const char *cookie)
 const char *AnalyserRequest::getCookies()
 {
     return _cookie;
-}
\ No newline at end of file
+}
+
+const char *AnalyserRequest::getAcceptEncoding()
+{
+    return _acceptEncoding;
+}
+
+bool AnalyserRequest::acceptsEncoding(const char *encoding)
+{
+    size_t len = strlen(encoding);
+    const char *item = _acceptEncoding;
+
+    // Accept-Encoding is a comma-separated list such as "gzip, deflate;q=0.5, br;q=0"
+    while (*item != '\0')
+    {
+        while (*item == ' ' || *item == ',')
+        {
+            item++;
+        }
+
+        const char *itemEnd = item;
+        while (*itemEnd != '\0' && *itemEnd != ',' && *itemEnd != ';' && *itemEnd != ' ')
+        {
+            itemEnd++;
+        }
+
+        if ((size_t)(itemEnd - item) == len && strncasecmp(item, encoding, len) == 0)
+        {
+            // An explicit quality of zero means "not acceptable"
+            const char *quality = strstr(itemEnd, "q=");
+            const char *next = strchr(itemEnd, ',');
+            if (quality != NULL && (next == NULL || quality < next))
+            {
+                return atof(quality + 2) > 0;
+            }
+            return true;
+        }
+
+        item = strchr(itemEnd, ',');
+        if (item == NULL)
+        {
+            break;
+        }
+    }
+
+    return false;
+}
+
+const char *AnalyserRequest::getUpgrade()
+{
+    return _upgrade;
+}
+
+const char *AnalyserRequest::getConnection()
+{
+    return _connection;
+}
+
+const char *AnalyserRequest::getWebSocketKey()
+{
+    return _webSocketKey;
+}
+
+int AnalyserRequest::getWebSocketVersion()
+{
+    return _webSocketVersion;
+}
+
+const char *AnalyserRequest::getLastEventId()
+{
+    return _lastEventId;
+}
+
+bool AnalyserRequest::expectsContinue()
+{
+    return _expectContinue;
+}
+
+const char *AnalyserRequest::getContentDigest()
+{
+    return _contentDigest;
+}
+
+const char *AnalyserRequest::getIfNoneMatch()
+{
+    return _ifNoneMatch;
+}
@@ -0,0 +1,66 @@
+#include "BufferedWriter.h"
+
+BufferedWriter::BufferedWriter(Print &output) : _output(output)
+{
+    _length = 0;
+    _bytesWritten = 0;
+    _failed = false;
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+}
+
+void BufferedWriter::writeOutput(const uint8_t *data, size_t size)
+{
+    if (_failed || size == 0)
+    {
+        return;
+    }
+
+    size_t written = _output.write(data, size);
+    _bytesWritten += written;
+    if (written != size)
+    {
+        _failed = true;
+    }
+}
+
+size_t BufferedWriter::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t BufferedWriter::write(const uint8_t *data, size_t size)
+{
+    if (_length + size > sizeof(_buffer))
+    {
+        flush();
+        if (size >= sizeof(_buffer))
+        {
+            writeOutput(data, size); // Would not fit anyway: no copy
+            return _failed ? 0 : size;
+        }
+    }
+
+    memcpy(_buffer + _length, data, size);
+    _length += size;
+    return _failed ? 0 : size;
+}
+
+void BufferedWriter::flush()
+{
+    writeOutput(_buffer, _length);
+    _length = 0;
+}
+
+bool BufferedWriter::failed()
+{
+    return _failed;
+}
+
+size_t BufferedWriter::getBytesWritten()
+{
+    return _bytesWritten;
+}
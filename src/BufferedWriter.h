@@ -0,0 +1,49 @@
+#ifndef BUFFERED_WRITER_H
+#define BUFFERED_WRITER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Size (in bytes) of the buffer of a BufferedWriter.
+ */
+#ifndef BUFFERED_WRITER_SIZE
+#define BUFFERED_WRITER_SIZE 512
+#endif
+
+/**
+ * @class BufferedWriter
+ * @brief Print that gathers small writes and passes them to its output in large blocks.
+ *
+ * Printing a request or response piece by piece straight to a Client costs one write (and
+ * often one TCP segment) per piece. BufferedWriter copies the pieces into a buffer and only
+ * writes to the output when the buffer is full or flush() is called; writes larger than the
+ * buffer go straight to the output after the pending data.
+ *
+ * A short write by the output is remembered and reported by failed(); the data that follows
+ * is discarded.
+ */
+class BufferedWriter : public Print
+{
+public:
+    BufferedWriter(Print &output);
+    ~BufferedWriter();
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *data, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+    bool failed();
+    size_t getBytesWritten();
+
+private:
+    void writeOutput(const uint8_t *data, size_t size);
+
+    Print &_output;
+    uint8_t _buffer[BUFFERED_WRITER_SIZE];
+    size_t _length;
+    size_t _bytesWritten;
+    bool _failed;
+};
+
+#endif // BUFFERED_WRITER_H
@@ -1,134 +1,400 @@
 #include "RequestsAndResponses.h"
+#include "BufferedWriter.h"
+
+uint32_t BuildResponse::_writeTimeoutMs = BUILD_RESPONSE_WRITE_TIMEOUT;
+uint32_t BuildResponse::_writeStalls = 0;
+
+__attribute__((weak)) bool sendFileNative(Client &, fs::File &, const uint8_t *, size_t, size_t, uint32_t, size_t *)
+{
+    return false; // No native path: the file is copied through a buffer
+}
 
 BuildResponse::BuildResponse(Client &client)
 {
     _client = &client;
 }
 
+BuildResponse::BuildResponse(Client &client, AnalyserRequest &request)
+{
+    _client = &client;
+    _omitBody = request.methodIs(MethodsHttp::HEAD);
+    _http10 = !request.isHttp11();
+    _ifNoneMatch = request.getIfNoneMatch();
+}
+
+BuildResponse::~BuildResponse()
+{
+    end();
+}
+
 void BuildResponse::begin(const char *code)
 {
-    _client->print("HTTP/1.1 ");
-    _client->println(code);
+    appendHead("HTTP/1.1 ");
+    appendHead(code);
+    appendHead("\r\n");
 }
 
 void BuildResponse::addHeader(const char *key, const char *value)
 {
-    _client->print(key);
-    _client->print(": ");
-    _client->println(value);
+    appendHead(key);
+    appendHead(": ");
+    appendHead(value);
+    appendHead("\r\n");
 }
-void BuildResponse::send(const char *contentType, const char *message, bool newLine)
+
+void BuildResponse::enableCompression(GzipEncoder &encoder, AnalyserRequest &request, size_t threshold)
 {
-    if (!_alreadyClosed)
+    // Compression is only used when the client accepts it, and decided when the headers are sent
+    if (!_alreadyClosed && request.acceptsEncoding("gzip"))
     {
-        _client->print("Content-Type: ");
-        _client->println(contentType);
-        _client->println("Connection: close");
-        _client->println();
-        _alreadyClosed = true;
+        _encoder = &encoder;
+        _compressionThreshold = threshold;
+        _omitBody = request.methodIs(MethodsHttp::HEAD);
+        _http10 = !request.isHttp11();
     }
+}
 
-    if (newLine)
+void BuildResponse::appendHead(const char *text)
+{
+    size_t len = strlen(text);
+    while (len > 0)
     {
-        _client->println(message);
+        if (_headLength == sizeof(_head))
+        {
+            flushHead();
+        }
+
+        size_t n = sizeof(_head) - _headLength;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(_head + _headLength, text, n);
+        _headLength += n;
+        text += n;
+        len -= n;
     }
-    else
+}
+
+void BuildResponse::flushHead()
+{
+    if (_headLength > 0)
     {
-        _client->print(message);
+        writeClient((const uint8_t *)_head, _headLength);
+        _headLength = 0;
     }
 }
 
-void BuildResponse::send(const char *message, bool newLine)
+void BuildResponse::writeHeaders(const char *contentType, size_t bodyLength, bool exactLength)
 {
+    if (_alreadyClosed)
+    {
+        return;
+    }
 
-    if (!_alreadyClosed)
+    if (contentType != nullptr)
     {
-        _client->print("Content-Type: ");
-        _client->println(ContentType::TEXT_PLAIN);
-        _client->println("Connection: close");
-        _client->println();
-        _alreadyClosed = true;
+        appendHead("Content-Type: ");
+        appendHead(contentType);
+        appendHead("\r\n");
     }
 
-    if (newLine)
+    // The decision to compress is taken from the first part of the body
+    if (_encoder != nullptr && !_omitBody && bodyLength > 0 && bodyLength >= _compressionThreshold)
+    {
+        appendHead("Content-Encoding: gzip\r\n");
+        appendHead("Vary: Accept-Encoding\r\n");
+
+        // HTTP/1.0 has no chunked encoding: the body then ends when the connection is closed
+        _chunked = !_http10;
+        if (_chunked)
+        {
+            appendHead("Transfer-Encoding: chunked\r\n");
+        }
+
+        _encoder->begin([this](const uint8_t *data, size_t size)
+                        { writeEncoded(data, size); });
+        _compressing = true;
+    }
+
+    // The length is only announced when the body is sent as it is (also for HEAD requests)
+    bool compressible = _encoder != nullptr && bodyLength > 0 && bodyLength >= _compressionThreshold;
+    if (exactLength && !compressible)
+    {
+        char length[24];
+        snprintf(length, sizeof(length), "%lu", (unsigned long)bodyLength);
+        appendHead("Content-Length: ");
+        appendHead(length);
+        appendHead("\r\n");
+    }
+
+    appendHead("Connection: close\r\n\r\n");
+    _alreadyClosed = true;
+}
+
+void BuildResponse::writeRaw(const uint8_t *data, size_t size)
+{
+    if (_headLength > 0)
     {
-        _client->println(message);
+        // Small bodies leave in the same write as the headers
+        if (_headLength + size <= sizeof(_head))
+        {
+            memcpy(_head + _headLength, data, size);
+            _headLength += size;
+            flushHead();
+            return;
+        }
+        flushHead();
+    }
+
+    writeClient(data, size);
+}
+
+void BuildResponse::writeClient(const uint8_t *data, size_t size)
+{
+    uint32_t lastProgress = millis();
+    while (size > 0 && !_stalled)
+    {
+        // Only what the connection accepts without blocking is written, when it reports it
+        size_t n = size;
+        int room = _client->availableForWrite();
+        if (room > 0)
+        {
+            _reportsRoom = true;
+            if ((size_t)room < n)
+            {
+                n = room;
+            }
+        }
+        else if (_reportsRoom)
+        {
+            n = 0; // Transmit buffer full
+        }
+
+        size_t written = n > 0 ? _client->write(data, n) : 0;
+        if (written > 0)
+        {
+            data += written;
+            size -= written;
+            lastProgress = millis();
+            continue;
+        }
+
+        // The client left or stopped reading: the response is abandoned instead of blocking the server
+        if (!_client->connected() || millis() - lastProgress >= _writeTimeoutMs)
+        {
+            abandon();
+            return;
+        }
+        yield();
+    }
+}
+
+void BuildResponse::abandon()
+{
+    _stalled = true;
+    _writeStalls++;
+    _client->stop();
+}
+
+bool BuildResponse::stalled()
+{
+    return _stalled;
+}
+
+void BuildResponse::setWriteTimeout(uint32_t timeoutMs)
+{
+    _writeTimeoutMs = timeoutMs;
+}
+
+uint32_t BuildResponse::getWriteStalls()
+{
+    return _writeStalls;
+}
+
+void BuildResponse::writeChunk(const uint8_t *data, size_t size)
+{
+    char chunkSize[12];
+    snprintf(chunkSize, sizeof(chunkSize), "%x\r\n", (unsigned int)size);
+    writeRaw((const uint8_t *)chunkSize, strlen(chunkSize));
+    writeRaw(data, size);
+    writeRaw((const uint8_t *)"\r\n", 2);
+}
+
+void BuildResponse::writeEncoded(const uint8_t *data, size_t size)
+{
+    if (_chunked)
+    {
+        writeChunk(data, size);
     }
     else
     {
-        _client->print(message);
+        writeRaw(data, size);
     }
 }
 
-void BuildResponse::send(const char *contentType, const uint8_t *contentGzip, uint32_t size, std::function<void()> callback)
+void BuildResponse::writeBody(const uint8_t *data, size_t size)
 {
-    if (!_alreadyClosed)
+    if (size == 0 || _omitBody)
     {
-        _client->print("Content-Type: ");
-        _client->println(contentType);
-        _client->println("Connection: close");
-        _client->println();
-        _alreadyClosed = true;
+        return;
     }
 
-    // Send the compressed data (the GZIP content)
-    for (uint32_t i = 0; i < size; i++)
+    if (_compressing)
+    {
+        _encoder->write(data, size);
+    }
+    else
+    {
+        writeRaw(data, size);
+    }
+}
+
+void BuildResponse::writeProgmem(const uint8_t *data, size_t size, std::function<void()> callback)
+{
+    if (_omitBody)
     {
-        // Execute the callback function if it is provided
+        return;
+    }
+
+    // Copied in blocks, since PROGMEM cannot be read like RAM on every board
+    uint8_t buffer[512];
+    while (size > 0 && !_stalled)
+    {
+        // Execute the callback function if it is provided (once per block)
         if (callback)
         {
             callback();
         }
-        
-        _client->write(pgm_read_byte_near(&contentGzip[i]));
+
+        size_t n = size < sizeof(buffer) ? size : sizeof(buffer);
+        memcpy_P(buffer, data, n);
+        writeBody(buffer, n);
+        data += n;
+        size -= n;
     }
 }
 
-void BuildResponse::send()
+BuildResponse::BodyWriter::BodyWriter(BuildResponse &response) : _response(response)
 {
-    if (!_alreadyClosed)
+}
+
+size_t BuildResponse::BodyWriter::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t BuildResponse::BodyWriter::write(const uint8_t *data, size_t size)
+{
+    _response.writeBody(data, size);
+    return _response._stalled ? 0 : size;
+}
+
+void BuildResponse::send(const char *contentType, const char *message, bool newLine)
+{
+    size_t len = strlen(message);
+    writeHeaders(contentType, len);
+
+    writeBody((const uint8_t *)message, len);
+    if (newLine)
     {
-        _client->println("Connection: close");
-        _client->println();
-        _alreadyClosed = true;
+        writeBody((const uint8_t *)"\r\n", 2);
     }
 }
 
-void BuildResponse::send(const char *contentType, const char *progmemContent, size_t size)
+void BuildResponse::send(const char *message, bool newLine)
 {
+    send(ContentType::TEXT_PLAIN, message, newLine);
+}
+
+void BuildResponse::send(const char *contentType, const uint8_t *contentGzip, uint32_t size, std::function<void()> callback)
+{
+    // The content is already compressed, so it is never compressed again
+    writeHeaders(contentType, 0);
+
+    // Send the compressed data (the GZIP content)
+    writeProgmem(contentGzip, size, callback);
+}
+
+void BuildResponse::send()
+{
+    writeHeaders(nullptr, 0);
+    flushHead();
+}
+
+void BuildResponse::openStream(const char *contentType)
+{
+    // Same as the headers of send(), but without "Connection: close"
     if (!_alreadyClosed)
     {
-        _client->print("Content-Type: ");
-        _client->println(contentType);
-        _client->println("Connection: close");
-        _client->println();
+        if (contentType != nullptr)
+        {
+            appendHead("Content-Type: ");
+            appendHead(contentType);
+            appendHead("\r\n");
+        }
+        appendHead("\r\n");
         _alreadyClosed = true;
     }
+    flushHead();
+}
 
-    // Envia o conteúdo em PROGMEM com um loop for
-    for (size_t i = 0; i < size; i++)
-    {
-        char byteFromProgmem = pgm_read_byte_near(progmemContent + i);
-        _client->write(byteFromProgmem);
-    }
+void BuildResponse::send(const char *contentType, const char *progmemContent, size_t size)
+{
+    writeHeaders(contentType, size);
+    writeProgmem((const uint8_t *)progmemContent, size);
 }
 
-void BuildResponse::send(const char *contentType, fs::FS &fs, const char *path)
+void BuildResponse::send(const char *contentType, PageTemplate &page, std::function<void(uint8_t id, Print &output)> resolver)
 {
-    if (!_alreadyClosed)
+    // The size of the values is not known: the template alone decides on compression
+    writeHeaders(contentType, page.getLiteralLength());
+    if (_omitBody)
     {
-        _client->print("Content-Type: ");
-        _client->println(contentType);
-        _client->println("Connection: close");
-        _client->println();
-        _alreadyClosed = true;
+        return;
     }
 
+    // The small values printed by the resolver leave together with the text around them
+    BodyWriter body(*this);
+    BufferedWriter output(body);
+    page.render(output, resolver);
+    output.flush();
+}
+
+void BuildResponse::send(const char *contentType, fs::FS &fs, const char *path)
+{
     File file = fs.open(path);
+    sendFile(contentType, file);
+}
+
+void BuildResponse::sendFile(const char *contentType, File &file)
+{
     // Verifica se o ponteiro do arquivo é válido e o arquivo não é um diretório
     if (!file || file.isDirectory())
     {
-        _client->println("Error: Invalid file");
+        writeHeaders(contentType, 0);
+        writeBody((const uint8_t *)"Error: Invalid file\r\n", 21);
+        return;
+    }
+
+    size_t size = file.size();
+    writeHeaders(contentType, size);
+    if (_omitBody)
+    {
+        file.close();
+        return;
+    }
+
+    // The platform may send the headers and the file without copying them (e.g. sendfile())
+    size_t sent;
+    if (!_compressing && !_stalled && sendFileNative(*_client, file, (const uint8_t *)_head, _headLength, size, _writeTimeoutMs, &sent))
+    {
+        _headLength = 0;
+        if (sent != size)
+        {
+            abandon();
+        }
+        file.close();
         return;
     }
 
@@ -137,9 +403,76 @@ void BuildResponse::send(const char *contentType, fs::FS &fs, const char *path)
     size_t bytesRead;
     while ((bytesRead = file.read(buffer, sizeof(buffer))) > 0)
     {
-        _client->write(buffer, bytesRead);
+        writeBody(buffer, bytesRead);
     }
 
     // Fecha o arquivo após o envio
     file.close();
-}
\ No newline at end of file
+}
+
+void BuildResponse::send(const char *contentType, FileCache &cache, fs::FS &fs, const char *path)
+{
+    FileCache::Hit hit;
+    if (!cache.get(fs, path, hit))
+    {
+        sendFile(contentType, hit.file); // Too large for the cache, or not found
+        return;
+    }
+
+    // The client already has this version of the file ("*" matches any)
+    if (_ifNoneMatch[0] != '\0' && (strcmp(_ifNoneMatch, "*") == 0 || strstr(_ifNoneMatch, hit.etag) != nullptr) &&
+        replaceStatus(StatusCode::Successful::_200_OK, StatusCode::Redirection::_304_NOT_MODIFIED))
+    {
+        addHeader("ETag", hit.etag);
+        send();
+        return;
+    }
+
+    if (!_alreadyClosed)
+    {
+        addHeader("ETag", hit.etag);
+    }
+    writeHeaders(contentType, hit.size, true);
+    writeBody(hit.data, hit.size);
+}
+
+bool BuildResponse::replaceStatus(const char *expected, const char *code)
+{
+    // Only possible while the status line is still in the buffer, before any header was sent
+    size_t prefix = 9; // "HTTP/1.1 "
+    size_t oldLength = strlen(expected);
+    size_t newLength = strlen(code);
+    if (_alreadyClosed || _headLength < prefix + oldLength + 2 || memcmp(_head, "HTTP/1.1 ", prefix) != 0 ||
+        memcmp(_head + prefix, expected, oldLength) != 0 || memcmp(_head + prefix + oldLength, "\r\n", 2) != 0 ||
+        _headLength - oldLength + newLength > sizeof(_head))
+    {
+        return false;
+    }
+
+    memmove(_head + prefix + newLength, _head + prefix + oldLength, _headLength - prefix - oldLength);
+    memcpy(_head + prefix, code, newLength);
+    _headLength = _headLength - oldLength + newLength;
+    return true;
+}
+
+void BuildResponse::end()
+{
+    if (_ended)
+    {
+        return;
+    }
+    _ended = true;
+
+    if (_compressing)
+    {
+        // Flush the compressed stream and terminate the chunked body
+        _encoder->finish();
+        _compressing = false;
+        if (_chunked)
+        {
+            writeRaw((const uint8_t *)"0\r\n\r\n", 5);
+        }
+    }
+
+    flushHead();
+}
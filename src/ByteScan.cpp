@@ -0,0 +1,183 @@
+#include "ByteScan.h"
+
+#if !defined(BYTE_SCAN_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#define BYTE_SCAN_AVX2
+#define BYTE_SCAN_SSE2
+#elif !defined(BYTE_SCAN_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define BYTE_SCAN_SSE2
+#elif !defined(BYTE_SCAN_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define BYTE_SCAN_NEON
+#endif
+
+// Word of the SWAR loop: 32 bits on the ESP32, 64 bits on 64-bit hosts
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t ScanWord;
+#define BYTE_SCAN_SWAR_NAME "SWAR64"
+#else
+typedef uint32_t ScanWord;
+#define BYTE_SCAN_SWAR_NAME "SWAR32"
+#endif
+
+// Lets the aligned words of a char buffer be read without breaking the aliasing rules
+typedef ScanWord __attribute__((may_alias)) AliasedScanWord;
+
+static const ScanWord ONES = (ScanWord)-1 / 0xFF; // 0x01 in every byte
+static const ScanWord HIGHS = ONES * 0x80;       // 0x80 in every byte
+
+// Copies the set into exactly BYTE_SCAN_MAX_SET bytes, repeating the first one in the unused places
+static void loadSet(const char *set, uint8_t bytes[BYTE_SCAN_MAX_SET])
+{
+    size_t count = 0;
+    while (count < BYTE_SCAN_MAX_SET && set[count] != '\0')
+    {
+        bytes[count] = set[count];
+        count++;
+    }
+    for (size_t i = count; i < BYTE_SCAN_MAX_SET; i++)
+    {
+        bytes[i] = count > 0 ? bytes[0] : 0;
+    }
+}
+
+static inline bool inSet(uint8_t c, const uint8_t bytes[BYTE_SCAN_MAX_SET])
+{
+    return c == bytes[0] || c == bytes[1] || c == bytes[2] || c == bytes[3];
+}
+
+// Non-zero when some byte of the word is zero; the lowest flagged byte is always a real zero
+static inline ScanWord zeroBytes(ScanWord word)
+{
+    return (word - ONES) & ~word & HIGHS;
+}
+
+size_t scanBytesReference(const char *data, size_t size, const char *set)
+{
+    uint8_t bytes[BYTE_SCAN_MAX_SET];
+    loadSet(set, bytes);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        if (inSet(data[i], bytes))
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t scanBytes(const char *data, size_t size, const char *set)
+{
+#if defined(BYTE_SCAN_SCALAR)
+    return scanBytesReference(data, size, set);
+#else
+    uint8_t bytes[BYTE_SCAN_MAX_SET];
+    loadSet(set, bytes);
+    size_t i = 0;
+
+#if defined(BYTE_SCAN_AVX2)
+    const __m256i wide0 = _mm256_set1_epi8(bytes[0]);
+    const __m256i wide1 = _mm256_set1_epi8(bytes[1]);
+    const __m256i wide2 = _mm256_set1_epi8(bytes[2]);
+    const __m256i wide3 = _mm256_set1_epi8(bytes[3]);
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, wide0), _mm256_cmpeq_epi8(block, wide1)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(block, wide2), _mm256_cmpeq_epi8(block, wide3)));
+        uint32_t mask = _mm256_movemask_epi8(found);
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+#if defined(BYTE_SCAN_SSE2)
+    const __m128i set0 = _mm_set1_epi8(bytes[0]);
+    const __m128i set1 = _mm_set1_epi8(bytes[1]);
+    const __m128i set2 = _mm_set1_epi8(bytes[2]);
+    const __m128i set3 = _mm_set1_epi8(bytes[3]);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, set0), _mm_cmpeq_epi8(block, set1)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(block, set2), _mm_cmpeq_epi8(block, set3)));
+        uint32_t mask = _mm_movemask_epi8(found);
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+#if defined(BYTE_SCAN_NEON)
+    const uint8x16_t set0 = vdupq_n_u8(bytes[0]);
+    const uint8x16_t set1 = vdupq_n_u8(bytes[1]);
+    const uint8x16_t set2 = vdupq_n_u8(bytes[2]);
+    const uint8x16_t set3 = vdupq_n_u8(bytes[3]);
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t block = vld1q_u8((const uint8_t *)(data + i));
+        uint8x16_t found = vorrq_u8(vorrq_u8(vceqq_u8(block, set0), vceqq_u8(block, set1)),
+                                    vorrq_u8(vceqq_u8(block, set2), vceqq_u8(block, set3)));
+        // Narrows the 16 comparison bytes to 4 bits each, in a 64-bit mask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+        if (mask != 0)
+        {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+#endif
+
+    // Bytes before the first aligned word (word loads must be aligned on the ESP32)
+    while (i < size && ((uintptr_t)(data + i) & (sizeof(ScanWord) - 1)) != 0)
+    {
+        if (inSet(data[i], bytes))
+        {
+            return i;
+        }
+        i++;
+    }
+
+    // SWAR: a byte equal to the delimiter becomes zero after the XOR with the delimiter repeated in the word
+    const ScanWord word0 = ONES * bytes[0];
+    const ScanWord word1 = ONES * bytes[1];
+    const ScanWord word2 = ONES * bytes[2];
+    const ScanWord word3 = ONES * bytes[3];
+    for (; i + sizeof(ScanWord) <= size; i += sizeof(ScanWord))
+    {
+        ScanWord word = *(const AliasedScanWord *)(data + i);
+        if ((zeroBytes(word ^ word0) | zeroBytes(word ^ word1) | zeroBytes(word ^ word2) | zeroBytes(word ^ word3)) != 0)
+        {
+            break; // The byte loop below finds its position, whatever the byte order
+        }
+    }
+
+    for (; i < size; i++)
+    {
+        if (inSet(data[i], bytes))
+        {
+            return i;
+        }
+    }
+    return size;
+#endif
+}
+
+const char *scanBytesImplementation()
+{
+#if defined(BYTE_SCAN_SCALAR)
+    return "scalar";
+#elif defined(BYTE_SCAN_AVX2)
+    return "AVX2";
+#elif defined(BYTE_SCAN_SSE2)
+    return "SSE2";
+#elif defined(BYTE_SCAN_NEON)
+    return "NEON";
+#else
+    return BYTE_SCAN_SWAR_NAME;
+#endif
+}
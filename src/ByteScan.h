@@ -0,0 +1,41 @@
+#ifndef BYTE_SCAN_H
+#define BYTE_SCAN_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Maximum number of bytes in the set searched by scanBytes().
+ */
+#define BYTE_SCAN_MAX_SET 4
+
+/*
+ * Define BYTE_SCAN_SCALAR to always use the byte-at-a-time reference implementation
+ * (e.g. to compare results or measure the gain of the vectorized paths).
+ */
+
+/**
+ * @brief Finds the first byte of data that belongs to a small set of delimiters.
+ *
+ * The set is given as a string of 1 to BYTE_SCAN_MAX_SET bytes, e.g. "\r\n" or "&;"
+ * (extra bytes are ignored). Several bytes are compared per step: 16 or 32 with SSE2/AVX2
+ * or NEON on host builds, a 32-bit word (64-bit on 64-bit hosts) with SWAR arithmetic
+ * on the ESP32. Only the bytes inside the given size are read.
+ *
+ * @param data Bytes to scan (not necessarily NUL-terminated).
+ * @param size Number of bytes to scan.
+ * @param set Delimiters to look for.
+ * @return Position of the first delimiter, or size when there is none.
+ */
+size_t scanBytes(const char *data, size_t size, const char *set);
+
+/**
+ * @brief Scalar implementation of scanBytes(), one byte at a time, used as reference.
+ */
+size_t scanBytesReference(const char *data, size_t size, const char *set);
+
+/**
+ * @brief Name of the implementation used by scanBytes() ("AVX2", "SSE2", "NEON", "SWAR32", "SWAR64" or "scalar").
+ */
+const char *scanBytesImplementation();
+
+#endif // BYTE_SCAN_H
@@ -0,0 +1,365 @@
+#include "Digest.h"
+
+static inline uint32_t rotateLeft(uint32_t value, uint8_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t readBigEndian32(const uint8_t *data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+Sha1::Sha1()
+{
+    begin();
+}
+
+void Sha1::begin()
+{
+    _state[0] = 0x67452301;
+    _state[1] = 0xEFCDAB89;
+    _state[2] = 0x98BADCFE;
+    _state[3] = 0x10325476;
+    _state[4] = 0xC3D2E1F0;
+    _length = 0;
+    _blockLength = 0;
+}
+
+void Sha1::processBlock(const uint8_t *block)
+{
+    uint32_t w[80];
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        w[i] = readBigEndian32(block + 4 * i);
+    }
+    for (uint8_t i = 16; i < 80; i++)
+    {
+        w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3], e = _state[4];
+    for (uint8_t i = 0; i < 80; i++)
+    {
+        uint32_t f, k;
+        if (i < 20)
+        {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        }
+        else if (i < 40)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        }
+        else if (i < 60)
+        {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+
+        uint32_t temp = rotateLeft(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rotateLeft(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    _state[0] += a;
+    _state[1] += b;
+    _state[2] += c;
+    _state[3] += d;
+    _state[4] += e;
+}
+
+void Sha1::update(const uint8_t *data, size_t size)
+{
+    _length += size;
+    while (size > 0)
+    {
+        // Full blocks are hashed straight from the input
+        if (_blockLength == 0 && size >= sizeof(_block))
+        {
+            processBlock(data);
+            data += sizeof(_block);
+            size -= sizeof(_block);
+            continue;
+        }
+
+        size_t n = sizeof(_block) - _blockLength;
+        if (n > size)
+        {
+            n = size;
+        }
+        memcpy(_block + _blockLength, data, n);
+        _blockLength += n;
+        data += n;
+        size -= n;
+
+        if (_blockLength == sizeof(_block))
+        {
+            processBlock(_block);
+            _blockLength = 0;
+        }
+    }
+}
+
+void Sha1::finish(uint8_t digest[20])
+{
+    uint64_t bits = _length * 8;
+
+    // Padding: a single 1 bit, zeros, then the message length in bits
+    static const uint8_t padding[64] = {0x80};
+    size_t padLength = _blockLength < 56 ? 56 - _blockLength : 120 - _blockLength;
+    update(padding, padLength);
+
+    uint8_t lengthBytes[8];
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        lengthBytes[i] = bits >> (56 - 8 * i);
+    }
+    update(lengthBytes, sizeof(lengthBytes));
+
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        digest[4 * i] = _state[i] >> 24;
+        digest[4 * i + 1] = _state[i] >> 16;
+        digest[4 * i + 2] = _state[i] >> 8;
+        digest[4 * i + 3] = _state[i];
+    }
+}
+
+static inline uint32_t rotateRight(uint32_t value, uint8_t bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static const uint32_t SHA256_K[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2};
+
+Sha256::Sha256()
+{
+    begin();
+}
+
+void Sha256::begin()
+{
+    _state[0] = 0x6A09E667;
+    _state[1] = 0xBB67AE85;
+    _state[2] = 0x3C6EF372;
+    _state[3] = 0xA54FF53A;
+    _state[4] = 0x510E527F;
+    _state[5] = 0x9B05688C;
+    _state[6] = 0x1F83D9AB;
+    _state[7] = 0x5BE0CD19;
+    _length = 0;
+    _blockLength = 0;
+}
+
+void Sha256::processBlock(const uint8_t *block)
+{
+    uint32_t w[64];
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        w[i] = readBigEndian32(block + 4 * i);
+    }
+    for (uint8_t i = 16; i < 64; i++)
+    {
+        uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+    uint32_t e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+    for (uint8_t i = 0; i < 64; i++)
+    {
+        uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+        uint32_t choice = (e & f) ^ (~e & g);
+        uint32_t temp1 = h + s1 + choice + SHA256_K[i] + w[i];
+        uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t temp2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    _state[0] += a;
+    _state[1] += b;
+    _state[2] += c;
+    _state[3] += d;
+    _state[4] += e;
+    _state[5] += f;
+    _state[6] += g;
+    _state[7] += h;
+}
+
+void Sha256::update(const uint8_t *data, size_t size)
+{
+    _length += size;
+    while (size > 0)
+    {
+        // Full blocks are hashed straight from the input
+        if (_blockLength == 0 && size >= sizeof(_block))
+        {
+            processBlock(data);
+            data += sizeof(_block);
+            size -= sizeof(_block);
+            continue;
+        }
+
+        size_t n = sizeof(_block) - _blockLength;
+        if (n > size)
+        {
+            n = size;
+        }
+        memcpy(_block + _blockLength, data, n);
+        _blockLength += n;
+        data += n;
+        size -= n;
+
+        if (_blockLength == sizeof(_block))
+        {
+            processBlock(_block);
+            _blockLength = 0;
+        }
+    }
+}
+
+void Sha256::finish(uint8_t digest[32])
+{
+    uint64_t bits = _length * 8;
+
+    // Same padding as SHA-1
+    static const uint8_t padding[64] = {0x80};
+    size_t padLength = _blockLength < 56 ? 56 - _blockLength : 120 - _blockLength;
+    update(padding, padLength);
+
+    uint8_t lengthBytes[8];
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        lengthBytes[i] = bits >> (56 - 8 * i);
+    }
+    update(lengthBytes, sizeof(lengthBytes));
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        digest[4 * i] = _state[i] >> 24;
+        digest[4 * i + 1] = _state[i] >> 16;
+        digest[4 * i + 2] = _state[i] >> 8;
+        digest[4 * i + 3] = _state[i];
+    }
+}
+
+size_t base64Encode(const uint8_t *data, size_t size, char *output, size_t outputSize)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t length = 4 * ((size + 2) / 3);
+    if (outputSize < length + 1)
+    {
+        return 0;
+    }
+
+    char *out = output;
+    size_t i = 0;
+    for (; i + 2 < size; i += 3)
+    {
+        uint32_t triple = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        *out++ = alphabet[(triple >> 18) & 0x3F];
+        *out++ = alphabet[(triple >> 12) & 0x3F];
+        *out++ = alphabet[(triple >> 6) & 0x3F];
+        *out++ = alphabet[triple & 0x3F];
+    }
+
+    if (i < size)
+    {
+        uint32_t triple = (uint32_t)data[i] << 16;
+        if (i + 1 < size)
+        {
+            triple |= (uint32_t)data[i + 1] << 8;
+        }
+        *out++ = alphabet[(triple >> 18) & 0x3F];
+        *out++ = alphabet[(triple >> 12) & 0x3F];
+        *out++ = i + 1 < size ? alphabet[(triple >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+
+    *out = '\0';
+    return length;
+}
+
+static int base64Value(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+    {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z')
+    {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0' + 52;
+    }
+    if (c == '+' || c == '-')
+    {
+        return 62;
+    }
+    if (c == '/' || c == '_')
+    {
+        return 63;
+    }
+    return -1;
+}
+
+size_t base64Decode(const char *text, uint8_t *output, size_t outputSize)
+{
+    uint32_t accumulator = 0;
+    uint8_t bits = 0;
+    size_t length = 0;
+
+    for (; *text != '\0' && *text != '='; text++)
+    {
+        int value = base64Value(*text);
+        if (value < 0)
+        {
+            return 0;
+        }
+
+        accumulator = (accumulator << 6) | value;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            if (length == outputSize)
+            {
+                return 0;
+            }
+            output[length++] = accumulator >> bits;
+        }
+    }
+
+    return length;
+}
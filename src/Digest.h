@@ -0,0 +1,73 @@
+#ifndef DIGEST_H
+#define DIGEST_H
+
+#include <Arduino.h>
+
+/**
+ * @class Sha1
+ * @brief Incremental SHA-1 hash (FIPS 180-4).
+ *
+ * Used to compute the Sec-WebSocket-Accept key of the WebSocket handshake.
+ */
+class Sha1
+{
+public:
+    Sha1();
+    void begin();
+    void update(const uint8_t *data, size_t size);
+    void finish(uint8_t digest[20]);
+
+private:
+    void processBlock(const uint8_t *block);
+
+    uint32_t _state[5];
+    uint64_t _length;
+    uint8_t _block[64];
+    uint8_t _blockLength;
+};
+
+/**
+ * @class Sha256
+ * @brief Incremental SHA-256 hash (FIPS 180-4).
+ *
+ * Used to verify the integrity of uploaded firmware while it is received.
+ */
+class Sha256
+{
+public:
+    Sha256();
+    void begin();
+    void update(const uint8_t *data, size_t size);
+    void finish(uint8_t digest[32]);
+
+private:
+    void processBlock(const uint8_t *block);
+
+    uint32_t _state[8];
+    uint64_t _length;
+    uint8_t _block[64];
+    uint8_t _blockLength;
+};
+
+/**
+ * @brief Encodes data in Base64 (RFC 4648) with padding.
+ *
+ * @param data Data to encode.
+ * @param size Number of bytes to encode.
+ * @param output Buffer that receives the encoded, null-terminated text.
+ * @param outputSize Size of the output buffer. At least 4 * ((size + 2) / 3) + 1 bytes are needed.
+ * @return Length of the encoded text, or 0 if the output buffer is too small.
+ */
+size_t base64Encode(const uint8_t *data, size_t size, char *output, size_t outputSize);
+
+/**
+ * @brief Decodes Base64 (RFC 4648) text, with or without padding.
+ *
+ * @param text Null-terminated text to decode.
+ * @param output Buffer that receives the decoded bytes.
+ * @param outputSize Size of the output buffer.
+ * @return Number of decoded bytes, or 0 if the text is invalid or does not fit.
+ */
+size_t base64Decode(const char *text, uint8_t *output, size_t outputSize);
+
+#endif // DIGEST_H
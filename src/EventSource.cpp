@@ -0,0 +1,291 @@
+#include "EventSource.h"
+
+EventSource::EventSource()
+{
+    _head = 0;
+    _nextId = 1;
+    _dropSlow = false;
+    _skipped = 0;
+    _dropped = 0;
+
+    for (size_t i = 0; i < EVENT_SOURCE_HISTORY; i++)
+    {
+        _history[i].id = 0;
+    }
+    for (size_t i = 0; i < EVENT_SOURCE_MAX_SUBSCRIBERS; i++)
+    {
+        _subscribers[i].client = nullptr;
+    }
+}
+
+void EventSource::setDropSlow(bool dropSlow)
+{
+    _dropSlow = dropSlow;
+}
+
+uint8_t EventSource::getSubscribers()
+{
+    uint8_t count = 0;
+    for (size_t i = 0; i < EVENT_SOURCE_MAX_SUBSCRIBERS; i++)
+    {
+        if (_subscribers[i].client != nullptr)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t EventSource::getSkipped()
+{
+    return _skipped;
+}
+
+uint32_t EventSource::getDropped()
+{
+    return _dropped;
+}
+
+uint32_t EventSource::oldestOffset()
+{
+    // First remembered event that has not been overwritten yet
+    for (uint32_t id = _nextId > EVENT_SOURCE_HISTORY ? _nextId - EVENT_SOURCE_HISTORY : 1; id < _nextId; id++)
+    {
+        const EventIndex &entry = _history[id % EVENT_SOURCE_HISTORY];
+        if (entry.id == id && _head - entry.start <= EVENT_SOURCE_BUFFER_SIZE)
+        {
+            return entry.start;
+        }
+    }
+    return _head;
+}
+
+bool EventSource::subscribe(Client &client, AnalyserRequest &request)
+{
+    Subscriber *subscriber = nullptr;
+    for (size_t i = 0; i < EVENT_SOURCE_MAX_SUBSCRIBERS; i++)
+    {
+        if (_subscribers[i].client == nullptr || !_subscribers[i].client->connected())
+        {
+            subscriber = &_subscribers[i];
+            break;
+        }
+    }
+
+    if (subscriber == nullptr)
+    {
+        BuildResponse response(client);
+        response.begin(StatusCode::ServerError::_503_SERVICE_UNAVAILABLE);
+        response.addHeader("Retry-After", "5");
+        response.send(ContentType::TEXT_PLAIN, "Too many event streams");
+        return false;
+    }
+
+    // By default only new events are sent; with Last-Event-ID the stream resumes after that event
+    uint32_t offset = _head;
+    const char *lastEventId = request.getLastEventId();
+    if (lastEventId[0] != '\0')
+    {
+        uint32_t next = strtoul(lastEventId, NULL, 10) + 1;
+        const EventIndex &entry = _history[next % EVENT_SOURCE_HISTORY];
+        if (entry.id == next && _head - entry.start <= EVENT_SOURCE_BUFFER_SIZE)
+        {
+            offset = entry.start;
+        }
+        else if (next < _nextId)
+        {
+            offset = oldestOffset(); // Some events were lost: send what is still available
+        }
+    }
+
+    BuildResponse response(client);
+    response.begin(StatusCode::Successful::_200_OK);
+    response.addHeader("Cache-Control", "no-cache");
+    response.openStream(ContentType::TEXT_EVENT_STREAM);
+
+    // A slot left by a stream that disconnected still holds its socket until it is stopped
+    if (subscriber->client != nullptr && subscriber->client != &client)
+    {
+        subscriber->client->stop();
+    }
+    subscriber->client = &client;
+    subscriber->offset = offset;
+    subscriber->partial = false;
+    subscriber->reportsRoom = false;
+    flush(*subscriber);
+    return true;
+}
+
+void EventSource::append(const char *text, size_t size)
+{
+    while (size > 0)
+    {
+        size_t position = _head % EVENT_SOURCE_BUFFER_SIZE;
+        size_t n = EVENT_SOURCE_BUFFER_SIZE - position;
+        if (n > size)
+        {
+            n = size;
+        }
+        memcpy(_buffer + position, text, n);
+        _head += n;
+        text += n;
+        size -= n;
+    }
+}
+
+void EventSource::append(const char *text)
+{
+    append(text, strlen(text));
+}
+
+uint32_t EventSource::publish(const char *data, const char *event)
+{
+    char id[12];
+    snprintf(id, sizeof(id), "%lu", (unsigned long)_nextId);
+
+    // An event name cannot span lines: it would end the event early
+    if (event != nullptr && event[strcspn(event, "\r\n")] != '\0')
+    {
+        return 0;
+    }
+
+    // Size of the formatted event: "id: ..\n", optional "event: ..\n", one "data: ..\n" per line, "\n".
+    // Lines of the data end at "\r\n", "\r" or "\n" (all are line terminators in an event stream),
+    // and each one is sent as a line of its own ending with "\n"
+    size_t size = 4 + strlen(id) + 1 + 1;
+    if (event != nullptr)
+    {
+        size += 7 + strlen(event) + 1;
+    }
+    size_t dataLength = strlen(data);
+    size += dataLength + 7;
+    for (size_t i = 0; i < dataLength; i++)
+    {
+        if (data[i] == '\r' && data[i + 1] == '\n')
+        {
+            size += 5;
+            i++;
+        }
+        else if (data[i] == '\r' || data[i] == '\n')
+        {
+            size += 6;
+        }
+    }
+
+    if (size > EVENT_SOURCE_BUFFER_SIZE)
+    {
+        return 0; // Does not fit in the buffer
+    }
+
+    uint32_t eventId = _nextId++;
+    EventIndex &entry = _history[eventId % EVENT_SOURCE_HISTORY];
+    entry.id = eventId;
+    entry.start = _head;
+
+    // The event is formatted once, in the buffer shared by all the subscribers
+    append("id: ");
+    append(id);
+    append("\n");
+    if (event != nullptr)
+    {
+        append("event: ");
+        append(event);
+        append("\n");
+    }
+
+    const char *line = data;
+    while (true)
+    {
+        const char *lineEnd = line + strcspn(line, "\r\n");
+        append("data: ");
+        append(line, lineEnd - line);
+        append("\n");
+        if (*lineEnd == '\0')
+        {
+            break;
+        }
+        line = lineEnd[0] == '\r' && lineEnd[1] == '\n' ? lineEnd + 2 : lineEnd + 1;
+    }
+    append("\n");
+
+    return eventId;
+}
+
+bool EventSource::flush(Subscriber &subscriber)
+{
+    while (subscriber.offset != _head)
+    {
+        size_t position = subscriber.offset % EVENT_SOURCE_BUFFER_SIZE;
+        size_t n = _head - subscriber.offset;
+        if (n > EVENT_SOURCE_BUFFER_SIZE - position)
+        {
+            n = EVENT_SOURCE_BUFFER_SIZE - position;
+        }
+
+        // Never write more than the connection accepts without blocking (when it reports it)
+        int room = subscriber.client->availableForWrite();
+        if (room > 0)
+        {
+            subscriber.reportsRoom = true;
+            if ((size_t)room < n)
+            {
+                n = room;
+            }
+        }
+        else if (subscriber.reportsRoom)
+        {
+            return false; // Transmit buffer full: writing would block every other subscriber
+        }
+
+        size_t written = subscriber.client->write((const uint8_t *)_buffer + position, n);
+        if (written > 0)
+        {
+            // Every event ends with an empty line, and only there is "\n\n" found
+            subscriber.offset += written;
+            subscriber.partial = _buffer[(subscriber.offset - 1) % EVENT_SOURCE_BUFFER_SIZE] != '\n' ||
+                                 _buffer[(subscriber.offset - 2) % EVENT_SOURCE_BUFFER_SIZE] != '\n';
+        }
+        if (written < n)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void EventSource::loop()
+{
+    for (size_t i = 0; i < EVENT_SOURCE_MAX_SUBSCRIBERS; i++)
+    {
+        Subscriber &subscriber = _subscribers[i];
+        if (subscriber.client == nullptr)
+        {
+            continue;
+        }
+
+        if (!subscriber.client->connected())
+        {
+            subscriber.client->stop();
+            subscriber.client = nullptr;
+            continue;
+        }
+
+        // Part of what this subscriber has not received was overwritten
+        if (_head - subscriber.offset > EVENT_SOURCE_BUFFER_SIZE)
+        {
+            // The rest of a partly sent event is gone: skipping would join its start to the next event
+            if (_dropSlow || subscriber.partial)
+            {
+                subscriber.client->stop();
+                subscriber.client = nullptr;
+                _dropped++;
+                continue;
+            }
+
+            subscriber.offset = oldestOffset();
+            _skipped++;
+        }
+
+        flush(subscriber);
+    }
+}
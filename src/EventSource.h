@@ -0,0 +1,107 @@
+#ifndef EVENT_SOURCE_H
+#define EVENT_SOURCE_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Maximum number of connections subscribed to an EventSource at the same time.
+ */
+#ifndef EVENT_SOURCE_MAX_SUBSCRIBERS
+#define EVENT_SOURCE_MAX_SUBSCRIBERS 4
+#endif
+
+/**
+ * @brief Size (in bytes) of the ring buffer shared by all the subscribers.
+ *
+ * It also bounds how far behind a subscriber can fall before events are skipped.
+ */
+#ifndef EVENT_SOURCE_BUFFER_SIZE
+#define EVENT_SOURCE_BUFFER_SIZE 2048
+#endif
+
+/**
+ * @brief Number of recent events remembered to resume streams with Last-Event-ID.
+ */
+#ifndef EVENT_SOURCE_HISTORY
+#define EVENT_SOURCE_HISTORY 16
+#endif
+
+/**
+ * @class EventSource
+ * @brief Server-Sent Events (text/event-stream) broadcaster.
+ *
+ * subscribe() answers a request with an event stream that stays open and registers the
+ * connection. publish() formats an event once, into a ring buffer shared by all the
+ * subscribers; loop() then writes to each subscriber what it has not received yet, keeping
+ * one offset per subscriber. The work done to publish an event does not depend on the
+ * number of subscribers. The data is split into "data:" lines at "\r\n", "\r" or "\n", so
+ * an event always ends at its only blank line; an event name containing a line break is
+ * refused (publish() returns 0).
+ *
+ * A subscriber that falls more than EVENT_SOURCE_BUFFER_SIZE bytes behind has lost events:
+ * it either skips to the oldest event still in the buffer, or is disconnected when
+ * setDropSlow(true) was called. A subscriber that had received only part of an event is
+ * always disconnected, since the rest of that event is gone; the browser reconnects and
+ * resumes with Last-Event-ID.
+ *
+ * loop() never waits for a subscriber: a connection that reports no room to write (e.g. a
+ * tab that stopped reading) gets nothing until it makes room, so it cannot hold up the
+ * others.
+ *
+ * A browser that reconnects sends the Last-Event-ID header; the stream then resumes after
+ * that event, if it is still in the buffer.
+ */
+class EventSource
+{
+public:
+    EventSource();
+
+    bool subscribe(Client &client, AnalyserRequest &request);
+    uint32_t publish(const char *data, const char *event = nullptr);
+    void loop();
+
+    void setDropSlow(bool dropSlow);
+    uint8_t getSubscribers();
+    uint32_t getSkipped();
+    uint32_t getDropped();
+
+private:
+    /**
+     * @brief Connection subscribed to the stream, its position in the buffer, whether it
+     * stopped in the middle of an event and whether its connection reports the room to write.
+     */
+    struct Subscriber
+    {
+        Client *client;
+        uint32_t offset;
+        bool partial;
+        bool reportsRoom;
+    };
+
+    /**
+     * @brief Identifier and position of an event published recently.
+     */
+    struct EventIndex
+    {
+        uint32_t id;
+        uint32_t start;
+    };
+
+    void append(const char *text);
+    void append(const char *text, size_t size);
+    uint32_t oldestOffset();
+    bool flush(Subscriber &subscriber);
+
+    char _buffer[EVENT_SOURCE_BUFFER_SIZE];
+    uint32_t _head;
+
+    EventIndex _history[EVENT_SOURCE_HISTORY];
+    uint32_t _nextId;
+
+    Subscriber _subscribers[EVENT_SOURCE_MAX_SUBSCRIBERS];
+    bool _dropSlow;
+    uint32_t _skipped;
+    uint32_t _dropped;
+};
+
+#endif // EVENT_SOURCE_H
@@ -0,0 +1,230 @@
+#include "FileCache.h"
+
+FileCache::FileCache(uint8_t *pool, size_t poolSize, size_t maxFileSize)
+{
+    _pool = pool;
+    _poolSize = pool != nullptr ? poolSize : 0;
+    _maxFileSize = maxFileSize;
+    _revalidateMs = FILE_CACHE_REVALIDATE_MS;
+    _clock = 0;
+    _hits = 0;
+    _misses = 0;
+
+    clear();
+}
+
+uint32_t FileCache::hashBytes(const uint8_t *data, size_t length, uint32_t hash)
+{
+    // FNV-1a
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int FileCache::find(const char *path, size_t pathLength, uint32_t hash)
+{
+    for (uint8_t i = 0; i < FILE_CACHE_MAX_ENTRIES; i++)
+    {
+        Entry &entry = _entries[i];
+        if (entry.used && entry.hash == hash && entry.pathLength == pathLength &&
+            memcmp(_pool + entry.offset, path, pathLength) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool FileCache::makeRoom(size_t length, int *index)
+{
+    while (true)
+    {
+        int unused = -1;
+        int oldest = -1;
+        for (uint8_t i = 0; i < FILE_CACHE_MAX_ENTRIES; i++)
+        {
+            if (!_entries[i].used)
+            {
+                unused = unused < 0 ? i : unused;
+            }
+            else if (oldest < 0 || (int32_t)(_entries[i].lastUsed - _entries[oldest].lastUsed) < 0)
+            {
+                oldest = i;
+            }
+        }
+
+        if (unused >= 0 && _poolSize - _used >= length)
+        {
+            *index = unused;
+            return true;
+        }
+        if (oldest < 0)
+        {
+            return false;
+        }
+        remove(oldest); // Least recently used
+    }
+}
+
+void FileCache::remove(int index)
+{
+    Entry &entry = _entries[index];
+    size_t length = entry.pathLength + entry.size;
+    size_t end = entry.offset + length;
+
+    // Keeps the files packed, so the free space is always in one piece at the end of the pool
+    memmove(_pool + entry.offset, _pool + end, _used - end);
+    _used -= length;
+    for (uint8_t i = 0; i < FILE_CACHE_MAX_ENTRIES; i++)
+    {
+        if (_entries[i].used && _entries[i].offset > entry.offset)
+        {
+            _entries[i].offset -= length;
+        }
+    }
+    entry.used = false;
+}
+
+int FileCache::load(File &file, const char *path, size_t pathLength, uint32_t hash)
+{
+    if (!file || file.isDirectory())
+    {
+        return -1;
+    }
+
+    size_t size = file.size();
+    int index;
+    if (size > _maxFileSize || pathLength + size > _poolSize || !makeRoom(pathLength + size, &index))
+    {
+        return -1; // Not admitted: sent from the file system
+    }
+
+    uint8_t *content = _pool + _used + pathLength;
+    size_t received = 0;
+    while (received < size)
+    {
+        size_t n = file.read(content + received, size - received);
+        if (n == 0)
+        {
+            file.seek(0);
+            return -1; // Read error: nothing was stored, the file is sent from the file system
+        }
+        received += n;
+    }
+    memcpy(_pool + _used, path, pathLength);
+
+    Entry &entry = _entries[index];
+    entry.hash = hash;
+    entry.offset = _used;
+    entry.pathLength = pathLength;
+    entry.size = size;
+    entry.lastWrite = file.getLastWrite();
+    entry.checked = millis();
+    entry.lastUsed = ++_clock;
+    snprintf(entry.etag, sizeof(entry.etag), "\"%x-%08x\"", (unsigned int)size, (unsigned int)hashBytes(content, size));
+    entry.used = true;
+
+    _used += pathLength + size;
+    file.close();
+    return index;
+}
+
+void FileCache::fill(int index, Hit &hit)
+{
+    Entry &entry = _entries[index];
+    hit.data = _pool + entry.offset + entry.pathLength;
+    hit.size = entry.size;
+    hit.etag = entry.etag;
+}
+
+bool FileCache::get(fs::FS &fs, const char *path, Hit &hit)
+{
+    size_t pathLength = strlen(path);
+    uint32_t hash = hashBytes((const uint8_t *)path, pathLength);
+    int index = find(path, pathLength, hash);
+    hit.file = File();
+
+    // The file is opened at most once per call: when it changed, it is loaded (or sent) from the same File
+    bool opened = false;
+    if (index >= 0 && millis() - _entries[index].checked >= _revalidateMs)
+    {
+        // Only the size and date are read; a file that changed is loaded again
+        hit.file = fs.open(path);
+        opened = true;
+        if (!hit.file || hit.file.isDirectory() || hit.file.size() != _entries[index].size || hit.file.getLastWrite() != _entries[index].lastWrite)
+        {
+            remove(index);
+            index = -1;
+        }
+        else
+        {
+            _entries[index].checked = millis();
+            hit.file.close();
+            hit.file = File();
+        }
+    }
+
+    if (index >= 0)
+    {
+        _hits++;
+        _entries[index].lastUsed = ++_clock;
+        fill(index, hit);
+        return true;
+    }
+
+    _misses++;
+    if (!opened)
+    {
+        hit.file = fs.open(path);
+    }
+    index = load(hit.file, path, pathLength, hash);
+    if (index < 0)
+    {
+        return false; // hit.file is sent as it is
+    }
+    hit.file = File();
+    fill(index, hit);
+    return true;
+}
+
+void FileCache::invalidate(const char *path)
+{
+    size_t pathLength = strlen(path);
+    int index = find(path, pathLength, hashBytes((const uint8_t *)path, pathLength));
+    if (index >= 0)
+    {
+        remove(index);
+    }
+}
+
+void FileCache::clear()
+{
+    for (uint8_t i = 0; i < FILE_CACHE_MAX_ENTRIES; i++)
+    {
+        _entries[i].used = false;
+    }
+    _used = 0;
+}
+
+void FileCache::setRevalidateInterval(uint32_t intervalMs)
+{
+    _revalidateMs = intervalMs;
+}
+
+uint32_t FileCache::getHits()
+{
+    return _hits;
+}
+
+uint32_t FileCache::getMisses()
+{
+    return _misses;
+}
+
+size_t FileCache::getUsed()
+{
+    return _used;
+}
@@ -0,0 +1,114 @@
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Maximum number of files a FileCache can hold.
+ */
+#ifndef FILE_CACHE_MAX_ENTRIES
+#define FILE_CACHE_MAX_ENTRIES 16
+#endif
+
+/**
+ * @brief Default time (in milliseconds) a cached file is served before its size and date are checked again.
+ */
+#ifndef FILE_CACHE_REVALIDATE_MS
+#define FILE_CACHE_REVALIDATE_MS 2000
+#endif
+
+/**
+ * @class FileCache
+ * @brief RAM cache of small files, in front of BuildResponse::send(contentType, cache, fs, path).
+ *
+ * Opening a file of SPIFFS or LittleFS looks the path up and reads flash on every request.
+ * The cache keeps the content of the files requested most often in a pool of memory provided
+ * by the sketch (RAM or PSRAM), keyed by path, together with the values of their
+ * Content-Length and ETag headers, so a hit is sent without touching the file system.
+ *
+ * Only files up to maxFileSize bytes are admitted; larger files are sent from the file system
+ * as before, from the file the cache opened to read its size, so a miss opens it only once. The files are packed one after the other in the pool: when a new file does not
+ * fit, the least recently used files are evicted and the ones after them moved down.
+ *
+ * A cached file is checked again (size and date of last write) once every revalidation
+ * interval (FILE_CACHE_REVALIDATE_MS, or setRevalidateInterval()) and reloaded when it
+ * changed. A sketch that rewrites a file calls invalidate() to stop serving the old content
+ * right away.
+ *
+ * The ETag lets a browser revalidate its own copy: when the If-None-Match header of the
+ * request names it, BuildResponse answers "304 Not Modified" without the body.
+ *
+ * Usage:
+ * @code
+ * static uint8_t pool[32 * 1024];
+ * FileCache cache(pool, sizeof(pool), 8 * 1024); // Files up to 8 KB
+ *
+ * BuildResponse response(client, request);
+ * response.begin(StatusCode::Successful::_200_OK);
+ * response.send(ContentType::TEXT_CSS, cache, LittleFS, "/style.css");
+ * @endcode
+ */
+class FileCache
+{
+public:
+    /**
+     * @brief Cached file, valid until the next call to the cache. When get() returns false,
+     * file is the file opened for the lookup (not admitted, or not found when it is invalid).
+     */
+    struct Hit
+    {
+        const uint8_t *data;
+        size_t size;
+        const char *etag;
+        File file;
+    };
+
+    FileCache(uint8_t *pool, size_t poolSize, size_t maxFileSize);
+
+    bool get(fs::FS &fs, const char *path, Hit &hit);
+    void invalidate(const char *path);
+    void clear();
+
+    void setRevalidateInterval(uint32_t intervalMs);
+    uint32_t getHits();
+    uint32_t getMisses();
+    size_t getUsed();
+
+private:
+    /**
+     * @brief Metadata of a cached file. The path is stored in the pool, followed by the content.
+     */
+    struct Entry
+    {
+        uint32_t hash;
+        size_t offset;
+        size_t pathLength;
+        size_t size;
+        time_t lastWrite;
+        uint32_t checked;
+        uint32_t lastUsed;
+        char etag[20];
+        bool used;
+    };
+
+    static uint32_t hashBytes(const uint8_t *data, size_t length, uint32_t hash = 2166136261u);
+
+    int find(const char *path, size_t pathLength, uint32_t hash);
+    int load(File &file, const char *path, size_t pathLength, uint32_t hash);
+    bool makeRoom(size_t length, int *index);
+    void remove(int index);
+    void fill(int index, Hit &hit);
+
+    uint8_t *_pool;
+    size_t _poolSize;
+    size_t _maxFileSize;
+    size_t _used;
+    Entry _entries[FILE_CACHE_MAX_ENTRIES];
+
+    uint32_t _revalidateMs;
+    uint32_t _clock;
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif // FILE_CACHE_H
@@ -0,0 +1,263 @@
+#include "GzipEncoder.h"
+
+// Base values and extra bits of the deflate length codes 257..285
+static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                         35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                         3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+// Base values and extra bits of the deflate distance codes 0..29
+static const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                           193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                           6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// CRC-32 (IEEE) computed one nibble at a time, to keep the table small
+static const uint32_t CRC_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+static uint32_t updateCrc(uint32_t crc, const uint8_t *data, size_t size)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+GzipEncoder::GzipEncoder()
+{
+    _sink = nullptr;
+}
+
+void GzipEncoder::begin(Sink sink)
+{
+    _sink = sink;
+    _start = 0;
+    _end = 0;
+    _outputLength = 0;
+    _bitBuffer = 0;
+    _bitCount = 0;
+    _crc = 0;
+    _inputSize = 0;
+    memset(_head, 0, sizeof(_head));
+
+    // gzip header: magic, deflate, no flags, no mtime, no extra flags, unknown OS
+    static const uint8_t header[10] = {0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF};
+    for (size_t i = 0; i < sizeof(header); i++)
+    {
+        putByte(header[i]);
+    }
+
+    // The whole stream is a single final block using the fixed Huffman codes
+    putBits(1, 1); // BFINAL
+    putBits(1, 2); // BTYPE = 01
+}
+
+void GzipEncoder::write(const uint8_t *data, size_t size)
+{
+    _crc = updateCrc(_crc, data, size);
+    _inputSize += size;
+
+    while (size > 0)
+    {
+        if (_end == sizeof(_window))
+        {
+            slide();
+        }
+
+        size_t n = sizeof(_window) - _end;
+        if (n > size)
+        {
+            n = size;
+        }
+        memcpy(_window + _end, data, n);
+        _end += n;
+        data += n;
+        size -= n;
+
+        compress(false);
+    }
+}
+
+void GzipEncoder::finish()
+{
+    compress(true);
+
+    putCode(0, 7); // End of block (symbol 256)
+    if (_bitCount > 0)
+    {
+        putBits(0, 8 - _bitCount); // Align to a byte boundary
+    }
+
+    // gzip trailer: CRC-32 and input size, little-endian
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        putByte(_crc >> (8 * i));
+    }
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        putByte(_inputSize >> (8 * i));
+    }
+
+    flushOutput();
+}
+
+uint16_t GzipEncoder::hash(uint16_t position)
+{
+    uint32_t value = _window[position] | (_window[position + 1] << 8) | (_window[position + 2] << 16);
+    return (value * 2654435761u) >> (32 - GZIP_HASH_BITS);
+}
+
+void GzipEncoder::slide()
+{
+    // Keep the most recent window as history and make room for new data
+    memmove(_window, _window + GZIP_WINDOW_SIZE, GZIP_WINDOW_SIZE);
+    _start -= GZIP_WINDOW_SIZE;
+    _end -= GZIP_WINDOW_SIZE;
+
+    // Hash entries store position + 1, so 0 means empty
+    for (size_t i = 0; i < (1 << GZIP_HASH_BITS); i++)
+    {
+        _head[i] = _head[i] > GZIP_WINDOW_SIZE ? _head[i] - GZIP_WINDOW_SIZE : 0;
+    }
+}
+
+void GzipEncoder::compress(bool flush)
+{
+    // Without flush, stop while a full match still fits in the buffered data
+    while (_start < _end && (flush || _end - _start >= MAX_MATCH))
+    {
+        uint16_t available = _end - _start;
+        uint16_t length = 0;
+        uint16_t distance = 0;
+
+        if (available >= MIN_MATCH)
+        {
+            uint16_t h = hash(_start);
+            uint16_t candidate = _head[h];
+            _head[h] = _start + 1;
+
+            if (candidate > 0)
+            {
+                candidate--;
+                uint16_t limit = available < MAX_MATCH ? available : MAX_MATCH;
+                const uint8_t *a = _window + candidate;
+                const uint8_t *b = _window + _start;
+                while (length < limit && a[length] == b[length])
+                {
+                    length++;
+                }
+                distance = _start - candidate;
+            }
+        }
+
+        if (length >= MIN_MATCH)
+        {
+            emitMatch(length, distance);
+
+            // Index the positions covered by the match so later data can refer to them
+            uint16_t last = _start + length;
+            for (uint16_t position = _start + 1; position < last && _end - position >= MIN_MATCH; position++)
+            {
+                _head[hash(position)] = position + 1;
+            }
+            _start = last;
+        }
+        else
+        {
+            emitLiteral(_window[_start]);
+            _start++;
+        }
+    }
+}
+
+void GzipEncoder::emitLiteral(uint8_t value)
+{
+    if (value < 144)
+    {
+        putCode(0x30 + value, 8);
+    }
+    else
+    {
+        putCode(0x190 + (value - 144), 9);
+    }
+}
+
+void GzipEncoder::emitMatch(uint16_t length, uint16_t distance)
+{
+    uint8_t code = 28;
+    while (LENGTH_BASE[code] > length)
+    {
+        code--;
+    }
+
+    uint16_t symbol = 257 + code;
+    if (symbol < 280)
+    {
+        putCode(symbol - 256, 7);
+    }
+    else
+    {
+        putCode(0xC0 + (symbol - 280), 8);
+    }
+    putBits(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASE[code] > distance)
+    {
+        code--;
+    }
+    putCode(code, 5);
+    putBits(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+void GzipEncoder::putCode(uint16_t code, uint8_t length)
+{
+    // Huffman codes are stored most significant bit first
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    putBits(reversed, length);
+}
+
+void GzipEncoder::putBits(uint32_t value, uint8_t count)
+{
+    _bitBuffer |= value << _bitCount;
+    _bitCount += count;
+    while (_bitCount >= 8)
+    {
+        _output[_outputLength++] = _bitBuffer & 0xFF;
+        if (_outputLength == sizeof(_output))
+        {
+            flushOutput();
+        }
+        _bitBuffer >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+void GzipEncoder::putByte(uint8_t value)
+{
+    _output[_outputLength++] = value;
+    if (_outputLength == sizeof(_output))
+    {
+        flushOutput();
+    }
+}
+
+void GzipEncoder::flushOutput()
+{
+    if (_outputLength > 0 && _sink)
+    {
+        _sink(_output, _outputLength);
+    }
+    _outputLength = 0;
+}
@@ -0,0 +1,83 @@
+#ifndef GZIP_ENCODER_H
+#define GZIP_ENCODER_H
+
+#include <Arduino.h>
+#include <functional>
+
+/**
+ * @brief Size (in bytes) of the history kept by GzipEncoder to find repeated strings.
+ *
+ * The encoder keeps two windows in memory, so this value is counted twice. Must be a power
+ * of two between 512 and 16384.
+ */
+#ifndef GZIP_WINDOW_SIZE
+#define GZIP_WINDOW_SIZE 1024
+#endif
+
+/**
+ * @brief Number of bits of the hash table used to find matches (2 bytes per entry).
+ */
+#ifndef GZIP_HASH_BITS
+#define GZIP_HASH_BITS 9
+#endif
+
+/**
+ * @brief Size (in bytes) of the compressed output buffer handed to the sink.
+ */
+#ifndef GZIP_OUTPUT_SIZE
+#define GZIP_OUTPUT_SIZE 512
+#endif
+
+/**
+ * @class GzipEncoder
+ * @brief Streaming gzip compressor with a small, fixed memory budget.
+ *
+ * Data written to the encoder is compressed with LZ77 over a sliding window of
+ * GZIP_WINDOW_SIZE bytes and encoded with the fixed Huffman codes of deflate (RFC 1951),
+ * which avoids building code tables in RAM. The gzip framing (RFC 1952) is added around it.
+ *
+ * The compressed stream is delivered to the sink in blocks of up to GZIP_OUTPUT_SIZE bytes.
+ * With the default values the encoder uses about 3.5 KB of RAM, all of it inside the
+ * object, so it can be declared once as a global and reused by every response.
+ */
+class GzipEncoder
+{
+public:
+    typedef std::function<void(const uint8_t *data, size_t size)> Sink;
+
+    GzipEncoder();
+
+    void begin(Sink sink);
+    void write(const uint8_t *data, size_t size);
+    void finish();
+
+private:
+    static const uint16_t MIN_MATCH = 3;
+    static const uint16_t MAX_MATCH = 258;
+
+    void compress(bool flush);
+    void slide();
+    void emitLiteral(uint8_t value);
+    void emitMatch(uint16_t length, uint16_t distance);
+    void putBits(uint32_t value, uint8_t count);
+    void putCode(uint16_t code, uint8_t length);
+    void putByte(uint8_t value);
+    void flushOutput();
+    uint16_t hash(uint16_t position);
+
+    uint8_t _window[2 * GZIP_WINDOW_SIZE];
+    uint16_t _head[1 << GZIP_HASH_BITS];
+    uint16_t _start;
+    uint16_t _end;
+
+    uint8_t _output[GZIP_OUTPUT_SIZE];
+    uint16_t _outputLength;
+    uint32_t _bitBuffer;
+    uint8_t _bitCount;
+
+    uint32_t _crc;
+    uint32_t _inputSize;
+    Sink _sink;
+};
+
+#endif // GZIP_ENCODER_H
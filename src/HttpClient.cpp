@@ -0,0 +1,614 @@
+#include "HttpClient.h"
+#include "ByteScan.h"
+
+ResponseParser::ResponseParser()
+{
+    begin();
+}
+
+void ResponseParser::begin(bool expectBody)
+{
+    _state = STATUS_LINE;
+    _lineLength = 0;
+    _expectBody = expectBody;
+    _statusCode = 0;
+    _httpMinorVersion = 1;
+    _contentLength = -1;
+    _chunked = false;
+    _keepAlive = true;
+    _remaining = 0;
+}
+
+void ResponseParser::onHeader(HeaderHandler handler)
+{
+    _headerHandler = handler;
+}
+
+void ResponseParser::onBody(BodyHandler handler)
+{
+    _bodyHandler = handler;
+}
+
+bool ResponseParser::headersComplete()
+{
+    return _state != STATUS_LINE && _state != HEADERS;
+}
+
+bool ResponseParser::complete()
+{
+    return _state == DONE;
+}
+
+bool ResponseParser::failed()
+{
+    return _state == FAILED;
+}
+
+int ResponseParser::getStatusCode()
+{
+    return _statusCode;
+}
+
+uint8_t ResponseParser::getHttpMinorVersion()
+{
+    return _httpMinorVersion;
+}
+
+long ResponseParser::getContentLength()
+{
+    return _contentLength;
+}
+
+bool ResponseParser::isChunked()
+{
+    return _chunked;
+}
+
+bool ResponseParser::keepAlive()
+{
+    return _keepAlive;
+}
+
+size_t ResponseParser::deliverBody(const uint8_t *data, size_t size)
+{
+    if (_state != BODY_UNTIL_CLOSE && size > _remaining)
+    {
+        size = _remaining;
+    }
+
+    if (_bodyHandler && size > 0)
+    {
+        _bodyHandler(data, size);
+    }
+
+    if (_state != BODY_UNTIL_CLOSE)
+    {
+        _remaining -= size;
+        if (_remaining == 0)
+        {
+            _state = _state == BODY ? DONE : CHUNK_DATA_END;
+        }
+    }
+    return size;
+}
+
+size_t ResponseParser::parse(const uint8_t *data, size_t size)
+{
+    size_t i = 0;
+    while (i < size && _state != DONE && _state != FAILED)
+    {
+        // The body is passed on in blocks, without copies
+        if (_state == BODY || _state == BODY_UNTIL_CLOSE || _state == CHUNK_DATA)
+        {
+            i += deliverBody(data + i, size - i);
+            continue;
+        }
+
+        // Everything else is line based: the line is copied up to its end in one step
+        size_t length = scanBytes((const char *)data + i, size - i, "\n");
+        size_t room = sizeof(_line) - 1 - _lineLength;
+        memcpy(_line + _lineLength, data + i, length < room ? length : room); // Longer lines are truncated
+        _lineLength += length < room ? length : room;
+        i += length;
+
+        if (i < size)
+        {
+            i++; // '\n'
+            if (_lineLength > 0 && _line[_lineLength - 1] == '\r')
+            {
+                _lineLength--;
+            }
+            _line[_lineLength] = '\0';
+            processLine();
+            _lineLength = 0;
+        }
+    }
+    return i;
+}
+
+void ResponseParser::finish()
+{
+    // Without Content-Length or chunks, the end of the connection ends the body
+    if (_state == BODY_UNTIL_CLOSE)
+    {
+        _state = DONE;
+    }
+    else if (_state != DONE)
+    {
+        _state = FAILED;
+    }
+}
+
+void ResponseParser::processLine()
+{
+    switch (_state)
+    {
+    case STATUS_LINE:
+        processStatusLine();
+        break;
+
+    case HEADERS:
+        if (_lineLength == 0)
+        {
+            endHeaders();
+        }
+        else
+        {
+            processHeader();
+        }
+        break;
+
+    case CHUNK_SIZE:
+    {
+        char *end;
+        unsigned long chunkSize = strtoul(_line, &end, 16);
+        if (end == _line || (*end != '\0' && *end != ';' && *end != ' '))
+        {
+            _state = FAILED;
+        }
+        else if (chunkSize == 0)
+        {
+            _state = TRAILERS;
+        }
+        else
+        {
+            _remaining = chunkSize;
+            _state = CHUNK_DATA;
+        }
+        break;
+    }
+
+    case CHUNK_DATA_END:
+        _state = _lineLength == 0 ? CHUNK_SIZE : FAILED;
+        break;
+
+    case TRAILERS:
+        if (_lineLength == 0)
+        {
+            _state = DONE;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void ResponseParser::processStatusLine()
+{
+    if (_lineLength == 0)
+    {
+        return; // Empty lines before the status line are ignored
+    }
+
+    // "HTTP/1.x DDD Reason"
+    if (strncmp(_line, "HTTP/1.", 7) != 0 || !isdigit((unsigned char)_line[7]) || _line[8] != ' ' ||
+        !isdigit((unsigned char)_line[9]) || !isdigit((unsigned char)_line[10]) || !isdigit((unsigned char)_line[11]) ||
+        (_line[12] != ' ' && _line[12] != '\0'))
+    {
+        _state = FAILED;
+        return;
+    }
+
+    _httpMinorVersion = _line[7] - '0';
+    _statusCode = (_line[9] - '0') * 100 + (_line[10] - '0') * 10 + (_line[11] - '0');
+    _keepAlive = _httpMinorVersion >= 1; // HTTP/1.0 closes by default
+    _state = HEADERS;
+}
+
+void ResponseParser::processHeader()
+{
+    char *colon = strchr(_line, ':');
+    if (colon == NULL)
+    {
+        return; // Not a header, ignored
+    }
+
+    *colon = '\0';
+    const char *key = _line;
+    const char *value = colon + 1;
+    while (*value == ' ' || *value == '\t')
+    {
+        value++;
+    }
+
+    if (strcasecmp(key, "Content-Length") == 0)
+    {
+        _contentLength = strtol(value, NULL, 10);
+    }
+    else if (strcasecmp(key, "Transfer-Encoding") == 0)
+    {
+        _chunked = strcasestr(value, "chunked") != NULL;
+    }
+    else if (strcasecmp(key, "Connection") == 0)
+    {
+        if (strcasestr(value, "close") != NULL)
+        {
+            _keepAlive = false;
+        }
+        else if (strcasestr(value, "keep-alive") != NULL)
+        {
+            _keepAlive = true;
+        }
+    }
+
+    if (_headerHandler)
+    {
+        _headerHandler(key, value);
+    }
+}
+
+void ResponseParser::endHeaders()
+{
+    // Interim response (100 Continue, ...): the final response follows
+    if (_statusCode >= 100 && _statusCode < 200)
+    {
+        bool expectBody = _expectBody;
+        begin(expectBody);
+        return;
+    }
+
+    if (!_expectBody || _statusCode == 204 || _statusCode == 304)
+    {
+        _state = DONE;
+    }
+    else if (_chunked)
+    {
+        _state = CHUNK_SIZE;
+    }
+    else if (_contentLength >= 0)
+    {
+        _remaining = _contentLength;
+        _state = _remaining > 0 ? BODY : DONE;
+    }
+    else
+    {
+        _keepAlive = false; // Only the end of the connection tells where the body ends
+        _state = BODY_UNTIL_CLOSE;
+    }
+}
+
+HttpConnectionPool::HttpConnectionPool(uint32_t idleTimeoutMs)
+{
+    _numConnections = 0;
+    _idleTimeoutMs = idleTimeoutMs;
+    _opened = 0;
+    _reused = 0;
+}
+
+bool HttpConnectionPool::addClient(Client &client)
+{
+    if (_numConnections >= HTTP_CLIENT_MAX_CONNECTIONS)
+    {
+        return false;
+    }
+
+    Connection &connection = _connections[_numConnections++];
+    connection.client = &client;
+    connection.host[0] = '\0';
+    connection.port = 0;
+    connection.lastUsed = 0;
+    connection.open = false;
+    connection.busy = false;
+    return true;
+}
+
+void HttpConnectionPool::close(Connection &connection)
+{
+    connection.client->stop();
+    connection.open = false;
+}
+
+void HttpConnectionPool::expire()
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < _numConnections; i++)
+    {
+        Connection &connection = _connections[i];
+        if (connection.open && !connection.busy &&
+            (now - connection.lastUsed >= _idleTimeoutMs || !connection.client->connected()))
+        {
+            close(connection);
+        }
+    }
+}
+
+Client *HttpConnectionPool::acquire(const char *host, uint16_t port, bool &reused)
+{
+    reused = false;
+    if (strlen(host) >= HTTP_CLIENT_HOST_SIZE)
+    {
+        return nullptr;
+    }
+
+    expire();
+
+    // An idle connection to the same server saves the TCP handshake
+    Connection *candidate = nullptr;
+    for (uint8_t i = 0; i < _numConnections; i++)
+    {
+        Connection &connection = _connections[i];
+        if (connection.busy)
+        {
+            continue;
+        }
+
+        if (connection.open && connection.port == port && strcasecmp(connection.host, host) == 0)
+        {
+            connection.busy = true;
+            reused = true;
+            _reused++;
+            return connection.client;
+        }
+
+        // Otherwise a closed Client is preferred, then the least recently used idle one
+        if (candidate == nullptr || (candidate->open && (!connection.open || (int32_t)(connection.lastUsed - candidate->lastUsed) < 0)))
+        {
+            candidate = &connection;
+        }
+    }
+
+    if (candidate == nullptr)
+    {
+        return nullptr; // All the clients are busy
+    }
+
+    if (candidate->open)
+    {
+        close(*candidate);
+    }
+
+    if (!candidate->client->connect(host, port))
+    {
+        candidate->client->stop();
+        return nullptr;
+    }
+
+    strcpy(candidate->host, host);
+    candidate->port = port;
+    candidate->open = true;
+    candidate->busy = true;
+    _opened++;
+    return candidate->client;
+}
+
+void HttpConnectionPool::release(Client *client, bool keepAlive)
+{
+    for (uint8_t i = 0; i < _numConnections; i++)
+    {
+        Connection &connection = _connections[i];
+        if (connection.client == client)
+        {
+            connection.busy = false;
+            connection.lastUsed = millis();
+            if (!keepAlive)
+            {
+                close(connection);
+            }
+            return;
+        }
+    }
+}
+
+uint8_t HttpConnectionPool::getIdle()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < _numConnections; i++)
+    {
+        if (_connections[i].open && !_connections[i].busy)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t HttpConnectionPool::getOpened()
+{
+    return _opened;
+}
+
+uint32_t HttpConnectionPool::getReused()
+{
+    return _reused;
+}
+
+HttpClient::HttpClient(HttpConnectionPool &pool) : _pool(pool)
+{
+    _timeoutMs = 5000;
+    _numHeaders = 0;
+}
+
+void HttpClient::setTimeout(uint32_t timeoutMs)
+{
+    _timeoutMs = timeoutMs;
+}
+
+bool HttpClient::addHeader(const char *key, const char *value)
+{
+    if (_numHeaders >= HTTP_CLIENT_MAX_HEADERS)
+    {
+        return false;
+    }
+
+    // The pointers are kept until the request is sent
+    _headerKeys[_numHeaders] = key;
+    _headerValues[_numHeaders] = value;
+    _numHeaders++;
+    return true;
+}
+
+void HttpClient::onHeader(ResponseParser::HeaderHandler handler)
+{
+    _response.onHeader(handler);
+}
+
+void HttpClient::onBody(ResponseParser::BodyHandler handler)
+{
+    _response.onBody(handler);
+}
+
+ResponseParser &HttpClient::getResponse()
+{
+    return _response;
+}
+
+int HttpClient::get(const char *host, uint16_t port, const char *path)
+{
+    return request(MethodsHttp::GET, host, port, path);
+}
+
+int HttpClient::post(const char *host, uint16_t port, const char *path, const char *contentType, const char *body)
+{
+    return request(MethodsHttp::POST, host, port, path, contentType, (const uint8_t *)body, strlen(body));
+}
+
+int HttpClient::request(MethodsHttp method, const char *host, uint16_t port, const char *path,
+                        const char *contentType, const uint8_t *body, size_t bodyLength)
+{
+    int result = CONNECTION_FAILED;
+
+    for (uint8_t attempt = 0; attempt < 2; attempt++)
+    {
+        bool reused;
+        Client *client = _pool.acquire(host, port, reused);
+        if (client == nullptr)
+        {
+            result = CONNECTION_FAILED;
+            break;
+        }
+
+        bool received = false;
+        result = exchange(*client, method, host, port, path, contentType, body, bodyLength, received);
+        _pool.release(client, result > 0 && _response.keepAlive());
+
+        // The server may have closed the idle connection just before it was reused: the request
+        // is sent again when it could not be written, or when the connection was closed without
+        // a byte of response and repeating the method is harmless. Never after a timeout: a slow
+        // server may have already handled it
+        bool closedUnanswered = result == INVALID_RESPONSE && !received && isIdempotent(method);
+        if (!reused || received || (result != WRITE_FAILED && !closedUnanswered))
+        {
+            break;
+        }
+    }
+
+    _numHeaders = 0;
+    return result;
+}
+
+bool HttpClient::isIdempotent(MethodsHttp method)
+{
+    return method == MethodsHttp::GET || method == MethodsHttp::HEAD || method == MethodsHttp::PUT ||
+           method == MethodsHttp::DELETE || method == MethodsHttp::OPTIONS;
+}
+
+int HttpClient::exchange(Client &client, MethodsHttp method, const char *host, uint16_t port, const char *path,
+                         const char *contentType, const uint8_t *body, size_t bodyLength, bool &received)
+{
+    {
+        BufferedWriter writer(client);
+        writer.print(methodName(method));
+        writer.print(' ');
+        writer.print(path);
+        writer.print(" HTTP/1.1\r\nHost: ");
+        writer.print(host);
+        if (port != 80)
+        {
+            writer.print(':');
+            writer.print((unsigned int)port);
+        }
+        writer.print("\r\n");
+
+        for (uint8_t i = 0; i < _numHeaders; i++)
+        {
+            writer.print(_headerKeys[i]);
+            writer.print(": ");
+            writer.print(_headerValues[i]);
+            writer.print("\r\n");
+        }
+
+        if (contentType != nullptr)
+        {
+            writer.print("Content-Type: ");
+            writer.print(contentType);
+            writer.print("\r\n");
+        }
+        if (bodyLength > 0 || method == MethodsHttp::POST || method == MethodsHttp::PUT || method == MethodsHttp::PATCH)
+        {
+            writer.print("Content-Length: ");
+            writer.print((unsigned long)bodyLength);
+            writer.print("\r\n");
+        }
+        writer.print("\r\n");
+
+        // A small body leaves in the same write as the headers
+        if (bodyLength > 0)
+        {
+            writer.write(body, bodyLength);
+        }
+
+        writer.flush();
+        if (writer.failed())
+        {
+            return WRITE_FAILED;
+        }
+    }
+
+    _response.begin(method != MethodsHttp::HEAD);
+
+    uint8_t buffer[128];
+    uint32_t lastData = millis();
+    while (!_response.complete() && !_response.failed())
+    {
+        int available = client.available();
+        if (available > 0)
+        {
+            int bytesRead = client.read(buffer, (size_t)available < sizeof(buffer) ? (size_t)available : sizeof(buffer));
+            if (bytesRead > 0)
+            {
+                received = true;
+                lastData = millis();
+                _response.parse(buffer, bytesRead);
+                continue;
+            }
+        }
+
+        if (!client.connected())
+        {
+            _response.finish();
+            break;
+        }
+        if (millis() - lastData >= _timeoutMs)
+        {
+            return TIMED_OUT;
+        }
+        yield();
+    }
+
+    if (!_response.complete())
+    {
+        return INVALID_RESPONSE;
+    }
+    return _response.getStatusCode();
+}
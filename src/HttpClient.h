@@ -0,0 +1,225 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include "RequestsAndResponses.h"
+#include "BufferedWriter.h"
+
+/**
+ * @brief Maximum length of a status line, header or chunk-size line of a response.
+ *
+ * Longer header lines are truncated; the rest of the response is still parsed.
+ */
+#ifndef HTTP_CLIENT_LINE_SIZE
+#define HTTP_CLIENT_LINE_SIZE 256
+#endif
+
+/**
+ * @brief Maximum number of connections managed by an HttpConnectionPool.
+ */
+#ifndef HTTP_CLIENT_MAX_CONNECTIONS
+#define HTTP_CLIENT_MAX_CONNECTIONS 4
+#endif
+
+/**
+ * @brief Maximum length of the host name a pooled connection is tagged with.
+ */
+#ifndef HTTP_CLIENT_HOST_SIZE
+#define HTTP_CLIENT_HOST_SIZE 64
+#endif
+
+/**
+ * @brief Maximum number of extra headers added to a single request.
+ */
+#ifndef HTTP_CLIENT_MAX_HEADERS
+#define HTTP_CLIENT_MAX_HEADERS 4
+#endif
+
+/**
+ * @class ResponseParser
+ * @brief Incremental parser of HTTP/1.x responses.
+ *
+ * parse() accepts the response in pieces of any size, as they arrive from the network,
+ * and keeps its state between calls. It reads the status line and the headers, then
+ * delivers the body to the body handler, delimited by Content-Length, by the chunked
+ * transfer coding or, when neither is present, by the end of the connection (finish()).
+ * Interim responses (1xx) are skipped.
+ */
+class ResponseParser
+{
+public:
+    /**
+     * @brief Handler called with each header of the response.
+     */
+    typedef std::function<void(const char *key, const char *value)> HeaderHandler;
+
+    /**
+     * @brief Handler called with each piece of the response body.
+     */
+    typedef std::function<void(const uint8_t *data, size_t size)> BodyHandler;
+
+    ResponseParser();
+
+    void begin(bool expectBody = true);
+    void onHeader(HeaderHandler handler);
+    void onBody(BodyHandler handler);
+
+    size_t parse(const uint8_t *data, size_t size);
+    void finish();
+
+    bool headersComplete();
+    bool complete();
+    bool failed();
+
+    int getStatusCode();
+    uint8_t getHttpMinorVersion();
+    long getContentLength();
+    bool isChunked();
+    bool keepAlive();
+
+private:
+    /**
+     * @brief States of the parser.
+     */
+    enum ParserState
+    {
+        STATUS_LINE,
+        HEADERS,
+        BODY,
+        BODY_UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILERS,
+        DONE,
+        FAILED
+    };
+
+    void processLine();
+    void processStatusLine();
+    void processHeader();
+    void endHeaders();
+    size_t deliverBody(const uint8_t *data, size_t size);
+
+    HeaderHandler _headerHandler;
+    BodyHandler _bodyHandler;
+
+    ParserState _state;
+    char _line[HTTP_CLIENT_LINE_SIZE];
+    size_t _lineLength;
+
+    bool _expectBody;
+    int _statusCode;
+    uint8_t _httpMinorVersion;
+    long _contentLength;
+    bool _chunked;
+    bool _keepAlive;
+    size_t _remaining;
+};
+
+/**
+ * @class HttpConnectionPool
+ * @brief Small pool of outbound connections kept open between requests (keep-alive).
+ *
+ * The pool does not create connections: the application adds the Client objects it owns
+ * (EthernetClient, WiFiClient, ...) with addClient(). acquire() returns an idle connection
+ * already open to the same host and port when there is one, which saves the TCP handshake;
+ * otherwise it connects a free Client, closing the least recently used idle connection if
+ * all of them are in use. Connections idle for longer than the idle timeout are closed.
+ */
+class HttpConnectionPool
+{
+public:
+    HttpConnectionPool(uint32_t idleTimeoutMs = 5000);
+
+    bool addClient(Client &client);
+
+    Client *acquire(const char *host, uint16_t port, bool &reused);
+    void release(Client *client, bool keepAlive);
+    void expire();
+
+    uint8_t getIdle();
+    uint32_t getOpened();
+    uint32_t getReused();
+
+private:
+    /**
+     * @brief Client added to the pool and the host it is connected to.
+     */
+    struct Connection
+    {
+        Client *client;
+        char host[HTTP_CLIENT_HOST_SIZE];
+        uint16_t port;
+        uint32_t lastUsed;
+        bool open;
+        bool busy;
+    };
+
+    void close(Connection &connection);
+
+    Connection _connections[HTTP_CLIENT_MAX_CONNECTIONS];
+    uint8_t _numConnections;
+    uint32_t _idleTimeoutMs;
+    uint32_t _opened;
+    uint32_t _reused;
+};
+
+/**
+ * @class HttpClient
+ * @brief Blocking HTTP/1.1 client that sends requests over an HttpConnectionPool.
+ *
+ * The request line, the headers and small bodies are gathered in a BufferedWriter and
+ * leave in a single write. The response is read with a ResponseParser; its headers and
+ * body are passed to the handlers set with onHeader() and onBody().
+ *
+ * After a complete response the connection goes back to the pool, unless the server asked
+ * to close it. A request on a reused connection that the server closed while it was idle is
+ * sent again once, on a new connection: when the request could not be written, or when the
+ * connection was closed without a byte of response and the method is idempotent (GET, HEAD,
+ * PUT, DELETE or OPTIONS). A request that timed out is never sent again.
+ *
+ * request() returns the status code of the response, or a negative Error.
+ */
+class HttpClient
+{
+public:
+    /**
+     * @brief Errors returned by request() instead of a status code.
+     */
+    enum Error
+    {
+        CONNECTION_FAILED = -1,
+        WRITE_FAILED = -2,
+        TIMED_OUT = -3,
+        INVALID_RESPONSE = -4
+    };
+
+    HttpClient(HttpConnectionPool &pool);
+
+    void setTimeout(uint32_t timeoutMs);
+    bool addHeader(const char *key, const char *value);
+    void onHeader(ResponseParser::HeaderHandler handler);
+    void onBody(ResponseParser::BodyHandler handler);
+
+    int request(MethodsHttp method, const char *host, uint16_t port, const char *path,
+                const char *contentType = nullptr, const uint8_t *body = nullptr, size_t bodyLength = 0);
+    int get(const char *host, uint16_t port, const char *path);
+    int post(const char *host, uint16_t port, const char *path, const char *contentType, const char *body);
+
+    ResponseParser &getResponse();
+
+private:
+    static bool isIdempotent(MethodsHttp method);
+    int exchange(Client &client, MethodsHttp method, const char *host, uint16_t port, const char *path,
+                 const char *contentType, const uint8_t *body, size_t bodyLength, bool &received);
+
+    HttpConnectionPool &_pool;
+    ResponseParser _response;
+    uint32_t _timeoutMs;
+
+    const char *_headerKeys[HTTP_CLIENT_MAX_HEADERS];
+    const char *_headerValues[HTTP_CLIENT_MAX_HEADERS];
+    uint8_t _numHeaders;
+};
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,675 @@
+#include "JsonParser.h"
+#include "ByteScan.h"
+
+static bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+JsonParser::JsonParser()
+{
+    _handler = nullptr;
+    _numBindings = 0;
+    reset();
+}
+
+void JsonParser::reset()
+{
+    _assigned = 0;
+    _status = PARSING;
+    _state = VALUE;
+    _isKey = false;
+    _position = 0;
+    _depth = 0;
+    _path[0] = '\0';
+    _pathLength = 0;
+    _value[0] = '\0';
+    _valueLength = 0;
+    _truncated = false;
+    _literal = nullptr;
+    _literalIndex = 0;
+    _codePoint = 0;
+    _hexDigits = 0;
+    _highSurrogate = 0;
+}
+
+void JsonParser::onEvent(Handler handler)
+{
+    _handler = handler;
+}
+
+bool JsonParser::addBinding(const char *path, void *target, size_t size, uint8_t type)
+{
+    if (_numBindings >= JSON_PARSER_MAX_BINDINGS)
+    {
+        return false;
+    }
+
+    Binding &binding = _bindings[_numBindings++];
+    binding.path = path;
+    binding.target = target;
+    binding.size = size;
+    binding.type = type;
+    return true;
+}
+
+bool JsonParser::bind(const char *path, char *target, size_t size)
+{
+    return size > 0 && addBinding(path, target, size, BIND_STRING);
+}
+
+bool JsonParser::bind(const char *path, int &target)
+{
+    return addBinding(path, &target, sizeof(target), BIND_INT);
+}
+
+bool JsonParser::bind(const char *path, long &target)
+{
+    return addBinding(path, &target, sizeof(target), BIND_LONG);
+}
+
+bool JsonParser::bind(const char *path, float &target)
+{
+    return addBinding(path, &target, sizeof(target), BIND_FLOAT);
+}
+
+bool JsonParser::bind(const char *path, bool &target)
+{
+    return addBinding(path, &target, sizeof(target), BIND_BOOL);
+}
+
+JsonParser::Status JsonParser::parse(const uint8_t *data, size_t length)
+{
+    const char *chars = (const char *)data;
+    size_t i = 0;
+    while (i < length && (_status == PARSING || _status == DONE))
+    {
+        if (_state == STRING_CHARS)
+        {
+            // The characters up to the next quote or backslash are copied at once
+            size_t n = scanBytes(chars + i, length - i, "\"\\");
+            if (n > 0)
+            {
+                appendValue(chars + i, n);
+                i += n;
+                _position += n;
+                continue;
+            }
+        }
+
+        if (!consume(chars[i]))
+        {
+            break; // _position is left on the byte in error
+        }
+        i++;
+        _position++;
+    }
+    return _status;
+}
+
+JsonParser::Status JsonParser::parse(const char *data)
+{
+    return parse((const uint8_t *)data, strlen(data));
+}
+
+JsonParser::Status JsonParser::finish()
+{
+    // A number is only known to be complete when something follows it
+    if (_status == PARSING && _state == NUMBER_CHARS && _depth == 0)
+    {
+        endNumber();
+    }
+    if (_status == PARSING)
+    {
+        _status = INCOMPLETE;
+    }
+    return _status;
+}
+
+JsonParser::Status JsonParser::parseBody(RequestReader &reader)
+{
+    uint8_t buffer[64];
+    size_t length;
+    while ((length = reader.readBody(buffer, sizeof(buffer))) > 0)
+    {
+        if (parse(buffer, length) != PARSING && _status != DONE)
+        {
+            return _status; // The rest of the body is not read
+        }
+    }
+
+    if (reader.getResult() != RequestReader::READY)
+    {
+        _status = BODY_STOPPED; // Answered by the reader (e.g. 408) or the client left
+        return _status;
+    }
+    return finish();
+}
+
+bool JsonParser::fail(Status status)
+{
+    _status = status;
+    return false;
+}
+
+bool JsonParser::consume(char c)
+{
+    switch (_state)
+    {
+    case STRING_CHARS:
+    case STRING_ESCAPE:
+    case STRING_UNICODE:
+        return consumeString(c);
+
+    case NUMBER_CHARS:
+        if (isNumberChar(c))
+        {
+            // Checked as it arrives, so a number longer than the buffer is still validated
+            if (!consumeNumber(c))
+            {
+                return fail(SYNTAX_ERROR);
+            }
+            appendValue(&c, 1);
+            return true;
+        }
+        if (!endNumber())
+        {
+            return false;
+        }
+        return consume(c); // The character after the number
+
+    case LITERAL_CHARS:
+        if (c != _literal[_literalIndex])
+        {
+            return fail(SYNTAX_ERROR);
+        }
+        if (_literal[++_literalIndex] == '\0')
+        {
+            emit(_literal[0] == 'n' ? NULL_VALUE : BOOLEAN, _literal);
+            endValue();
+        }
+        return true;
+
+    default:
+        break;
+    }
+
+    if (isWhitespace(c))
+    {
+        return true;
+    }
+
+    switch (_state)
+    {
+    case VALUE:
+        if (_depth > 0 && _levels[_depth - 1].array)
+        {
+            if (c == ']' && _levels[_depth - 1].index == 0)
+            {
+                return close(true); // Empty array
+            }
+            if (!enterItem())
+            {
+                return false;
+            }
+        }
+        return startValue(c);
+
+    case KEY:
+        if (c == '}' && _levels[_depth - 1].index == 0)
+        {
+            return close(false); // Empty object
+        }
+        if (c != '"')
+        {
+            return fail(SYNTAX_ERROR);
+        }
+        _isKey = true;
+        _valueLength = 0;
+        _truncated = false;
+        _state = STRING_CHARS;
+        return true;
+
+    case COLON:
+        if (c != ':')
+        {
+            return fail(SYNTAX_ERROR);
+        }
+        _state = VALUE;
+        return true;
+
+    case NEXT:
+        if (c == ',')
+        {
+            Level &level = _levels[_depth - 1];
+            level.index++;
+            _state = level.array ? VALUE : KEY;
+            return true;
+        }
+        if (c == '}' || c == ']')
+        {
+            return close(c == ']');
+        }
+        return fail(SYNTAX_ERROR);
+
+    default: // END
+        return fail(SYNTAX_ERROR);
+    }
+}
+
+bool JsonParser::consumeString(char c)
+{
+    if (_state == STRING_UNICODE)
+    {
+        int digit = hexValue(c);
+        if (digit < 0)
+        {
+            return fail(SYNTAX_ERROR);
+        }
+        _codePoint = (_codePoint << 4) | digit;
+        if (++_hexDigits < 4)
+        {
+            return true;
+        }
+
+        // Characters outside the BMP come as a pair of surrogates; a lone one becomes U+FFFD
+        if (_codePoint >= 0xDC00 && _codePoint < 0xE000 && _highSurrogate != 0)
+        {
+            uint32_t codePoint = 0x10000 + (((uint32_t)_highSurrogate - 0xD800) << 10) + (_codePoint - 0xDC00);
+            _highSurrogate = 0;
+            appendCodePoint(codePoint);
+        }
+        else if (_codePoint >= 0xD800 && _codePoint < 0xDC00)
+        {
+            flushSurrogate();
+            _highSurrogate = _codePoint;
+        }
+        else
+        {
+            appendCodePoint(_codePoint >= 0xD800 && _codePoint < 0xE000 ? 0xFFFD : _codePoint);
+        }
+        _state = STRING_CHARS;
+        return true;
+    }
+
+    if (_state == STRING_ESCAPE)
+    {
+        char decoded;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            decoded = c;
+            break;
+        case 'b':
+            decoded = '\b';
+            break;
+        case 'f':
+            decoded = '\f';
+            break;
+        case 'n':
+            decoded = '\n';
+            break;
+        case 'r':
+            decoded = '\r';
+            break;
+        case 't':
+            decoded = '\t';
+            break;
+        case 'u':
+            _codePoint = 0;
+            _hexDigits = 0;
+            _state = STRING_UNICODE;
+            return true;
+        default:
+            return fail(SYNTAX_ERROR);
+        }
+        appendValue(&decoded, 1);
+        _state = STRING_CHARS;
+        return true;
+    }
+
+    if (c == '\\')
+    {
+        _state = STRING_ESCAPE;
+        return true;
+    }
+    if (c != '"')
+    {
+        appendValue(&c, 1);
+        return true;
+    }
+
+    // End of the string
+    flushSurrogate();
+    _value[_valueLength] = '\0';
+    if (_isKey)
+    {
+        _isKey = false;
+        _state = COLON;
+        return setKeyPath();
+    }
+    emit(STRING, _value);
+    endValue();
+    return true;
+}
+
+bool JsonParser::startValue(char c)
+{
+    _valueLength = 0;
+    _truncated = false;
+
+    if (c == '{' || c == '[')
+    {
+        return open(c == '[');
+    }
+    if (c == '"')
+    {
+        _state = STRING_CHARS;
+        return true;
+    }
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        appendValue(&c, 1);
+        _numberPart = c == '-' ? NUMBER_SIGN : c == '0' ? NUMBER_ZERO : NUMBER_INTEGER;
+        _state = NUMBER_CHARS;
+        return true;
+    }
+
+    _literal = c == 't' ? "true" : c == 'f' ? "false" : c == 'n' ? "null" : nullptr;
+    if (_literal == nullptr)
+    {
+        return fail(SYNTAX_ERROR);
+    }
+    _literalIndex = 1;
+    _state = LITERAL_CHARS;
+    return true;
+}
+
+bool JsonParser::enterItem()
+{
+    // "<path of the array>[<index>]"
+    Level &level = _levels[_depth - 1];
+    int n = snprintf(_path + level.pathLength, sizeof(_path) - level.pathLength, "[%lu]", (unsigned long)level.index);
+    if (n < 0 || (size_t)n >= sizeof(_path) - level.pathLength)
+    {
+        return fail(TOO_DEEP);
+    }
+    _pathLength = level.pathLength + n;
+    return true;
+}
+
+bool JsonParser::setKeyPath()
+{
+    // "<path of the object>.<key>", or only the key at the first level
+    // A truncated key could match a bound path that is only its prefix
+    uint16_t length = _levels[_depth - 1].pathLength;
+    size_t needed = length + (length > 0 ? 1 : 0) + _valueLength;
+    if (_truncated || needed >= sizeof(_path))
+    {
+        return fail(TOO_DEEP);
+    }
+    if (length > 0)
+    {
+        _path[length++] = '.';
+    }
+    memcpy(_path + length, _value, _valueLength + 1);
+    _pathLength = needed;
+    return true;
+}
+
+bool JsonParser::open(bool array)
+{
+    if (_depth >= JSON_PARSER_MAX_DEPTH)
+    {
+        return fail(TOO_DEEP);
+    }
+
+    emit(array ? ARRAY_START : OBJECT_START, "");
+    Level &level = _levels[_depth++];
+    level.array = array;
+    level.pathLength = _pathLength;
+    level.index = 0;
+    _state = array ? VALUE : KEY;
+    return true;
+}
+
+bool JsonParser::close(bool array)
+{
+    if (_depth == 0 || _levels[_depth - 1].array != array)
+    {
+        return fail(SYNTAX_ERROR);
+    }
+
+    // Back to the path of the container
+    _pathLength = _levels[--_depth].pathLength;
+    _path[_pathLength] = '\0';
+    emit(array ? ARRAY_END : OBJECT_END, "");
+    endValue();
+    return true;
+}
+
+void JsonParser::endValue()
+{
+    if (_depth > 0)
+    {
+        _state = NEXT;
+    }
+    else
+    {
+        _state = END;
+        _status = DONE;
+    }
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool JsonParser::consumeNumber(char c)
+{
+    bool digit = c >= '0' && c <= '9';
+    switch (_numberPart)
+    {
+    case NUMBER_SIGN:
+        _numberPart = c == '0' ? NUMBER_ZERO : NUMBER_INTEGER;
+        return digit;
+    case NUMBER_ZERO:
+    case NUMBER_INTEGER:
+        if (digit)
+        {
+            return _numberPart == NUMBER_INTEGER; // No digit after a leading zero
+        }
+        if (c == '.')
+        {
+            _numberPart = NUMBER_POINT;
+            return true;
+        }
+        _numberPart = NUMBER_E;
+        return c == 'e' || c == 'E';
+    case NUMBER_POINT:
+        _numberPart = NUMBER_FRACTION;
+        return digit;
+    case NUMBER_FRACTION:
+        if (digit)
+        {
+            return true;
+        }
+        _numberPart = NUMBER_E;
+        return c == 'e' || c == 'E';
+    case NUMBER_E:
+        _numberPart = digit ? NUMBER_EXPONENT : NUMBER_EXPONENT_SIGN;
+        return digit || c == '+' || c == '-';
+    case NUMBER_EXPONENT_SIGN:
+    case NUMBER_EXPONENT:
+        _numberPart = NUMBER_EXPONENT;
+        return digit;
+    }
+    return false;
+}
+
+bool JsonParser::endNumber()
+{
+    _value[_valueLength] = '\0';
+    if (_numberPart != NUMBER_ZERO && _numberPart != NUMBER_INTEGER && _numberPart != NUMBER_FRACTION && _numberPart != NUMBER_EXPONENT)
+    {
+        return fail(SYNTAX_ERROR); // Ends after "-", "." or the exponent marker
+    }
+    emit(NUMBER, _value);
+    endValue();
+    return true;
+}
+
+void JsonParser::appendValue(const char *data, size_t length)
+{
+    flushSurrogate();
+
+    size_t room = sizeof(_value) - 1 - _valueLength;
+    if (length > room)
+    {
+        length = room;
+        _truncated = true;
+    }
+    memcpy(_value + _valueLength, data, length);
+    _valueLength += length;
+}
+
+void JsonParser::appendCodePoint(uint32_t codePoint)
+{
+    char utf8[4];
+    size_t length;
+    if (codePoint < 0x80)
+    {
+        utf8[0] = codePoint;
+        length = 1;
+    }
+    else if (codePoint < 0x800)
+    {
+        utf8[0] = 0xC0 | (codePoint >> 6);
+        utf8[1] = 0x80 | (codePoint & 0x3F);
+        length = 2;
+    }
+    else if (codePoint < 0x10000)
+    {
+        utf8[0] = 0xE0 | (codePoint >> 12);
+        utf8[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+        utf8[2] = 0x80 | (codePoint & 0x3F);
+        length = 3;
+    }
+    else
+    {
+        utf8[0] = 0xF0 | (codePoint >> 18);
+        utf8[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+        utf8[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+        utf8[3] = 0x80 | (codePoint & 0x3F);
+        length = 4;
+    }
+    appendValue(utf8, length);
+}
+
+void JsonParser::flushSurrogate()
+{
+    // A high surrogate that was not followed by a low one
+    if (_highSurrogate != 0)
+    {
+        _highSurrogate = 0;
+        appendCodePoint(0xFFFD);
+    }
+}
+
+void JsonParser::emit(Event event, const char *value)
+{
+    if (event >= STRING)
+    {
+        assign(event, value);
+    }
+    if (_handler)
+    {
+        _handler(event, _path, value);
+    }
+}
+
+void JsonParser::assign(Event event, const char *value)
+{
+    for (uint8_t i = 0; i < _numBindings; i++)
+    {
+        Binding &binding = _bindings[i];
+        if (strcmp(binding.path, _path) != 0)
+        {
+            continue;
+        }
+
+        // A value of another type leaves the variable as it is
+        if (binding.type == BIND_STRING && event == STRING)
+        {
+            strncpy((char *)binding.target, value, binding.size - 1);
+            ((char *)binding.target)[binding.size - 1] = '\0';
+        }
+        else if ((binding.type == BIND_INT || binding.type == BIND_LONG) && event == NUMBER)
+        {
+            // "1.5" or "1e3" are converted through a double
+            long number = strpbrk(value, ".eE") != nullptr ? (long)strtod(value, nullptr) : strtol(value, nullptr, 10);
+            if (binding.type == BIND_INT)
+            {
+                *(int *)binding.target = number;
+            }
+            else
+            {
+                *(long *)binding.target = number;
+            }
+        }
+        else if (binding.type == BIND_FLOAT && event == NUMBER)
+        {
+            *(float *)binding.target = strtof(value, nullptr);
+        }
+        else if (binding.type == BIND_BOOL && event == BOOLEAN)
+        {
+            *(bool *)binding.target = value[0] == 't';
+        }
+        else
+        {
+            continue;
+        }
+        _assigned++;
+    }
+}
+
+JsonParser::Status JsonParser::getStatus()
+{
+    return _status;
+}
+
+size_t JsonParser::getPosition()
+{
+    return _position;
+}
+
+uint32_t JsonParser::getAssigned()
+{
+    return _assigned;
+}
+
+bool JsonParser::isTruncated()
+{
+    return _truncated;
+}
@@ -0,0 +1,235 @@
+#ifndef JSON_PARSER_H
+#define JSON_PARSER_H
+
+#include "RequestsAndResponses.h"
+
+class RequestReader;
+
+/**
+ * @brief Maximum nesting of objects and arrays accepted by a JsonParser.
+ */
+#ifndef JSON_PARSER_MAX_DEPTH
+#define JSON_PARSER_MAX_DEPTH 8
+#endif
+
+/**
+ * @brief Size of the buffer of the path of the current value (e.g. "wifi.ssid" or "leds[2].on").
+ */
+#ifndef JSON_PARSER_PATH_SIZE
+#define JSON_PARSER_PATH_SIZE 64
+#endif
+
+/**
+ * @brief Size of the buffer of a key, string or number; longer values are truncated.
+ */
+#ifndef JSON_PARSER_VALUE_SIZE
+#define JSON_PARSER_VALUE_SIZE 64
+#endif
+
+/**
+ * @brief Maximum number of fields bound with JsonParser::bind().
+ */
+#ifndef JSON_PARSER_MAX_BINDINGS
+#define JSON_PARSER_MAX_BINDINGS 16
+#endif
+
+/**
+ * @class JsonParser
+ * @brief Incremental JSON parser that reads a body in pieces of any size, without allocating memory.
+ *
+ * parse() takes the body as it arrives, split anywhere (even in the middle of a string, an
+ * escape or a number), and reports each value as soon as it is complete, with the path where
+ * it is in the document: keys are joined by '.' and array items get their index, so in
+ * {"wifi":{"ssid":"net"},"leds":[{"on":true}]} the values are at "wifi.ssid" and "leds[0].on".
+ * The document itself has the empty path. The memory used is that of the object, whatever the
+ * size of the body: only the current path and the current value are kept.
+ *
+ * Values can be received by a handler (onEvent()), which is also told where each object and
+ * array starts and ends, or stored straight into variables of the sketch with bind(). Strings
+ * are decoded (escapes, and \uXXXX sequences written as UTF-8); numbers are given as written.
+ * Strings and numbers longer than JSON_PARSER_VALUE_SIZE - 1 bytes are truncated, and
+ * isTruncated() tells so while the handler runs; a number is still checked in full.
+ *
+ * The document is checked as it is read: parse() stops at the first error, with the status
+ * SYNTAX_ERROR or TOO_DEEP (more than JSON_PARSER_MAX_DEPTH levels, a path longer than
+ * JSON_PARSER_PATH_SIZE - 1, or a key longer than JSON_PARSER_VALUE_SIZE - 1). Control characters inside strings are accepted. When the
+ * body ends, finish() completes a number at the end of the document and returns INCOMPLETE
+ * if the document was cut short.
+ *
+ * parseBody() reads the body of a request with a RequestReader and parses each piece as soon
+ * as it is received. It returns BODY_STOPPED when the body stopped coming (deadline or closed
+ * connection): the reader has then already answered, so the handler sends nothing.
+ *
+ * Usage:
+ * @code
+ * char ssid[33] = "";
+ * int port = 80;
+ * JsonParser parser;
+ * parser.bind("wifi.ssid", ssid, sizeof(ssid));
+ * parser.bind("server.port", port);
+ * JsonParser::Status status = parser.parseBody(reader);
+ * if (status == JsonParser::DONE) { ... } // 200
+ * else if (status != JsonParser::BODY_STOPPED) { ... } // 400
+ * @endcode
+ */
+class JsonParser
+{
+public:
+    /**
+     * @brief What was found in the document.
+     */
+    enum Event
+    {
+        OBJECT_START,
+        OBJECT_END,
+        ARRAY_START,
+        ARRAY_END,
+        STRING,
+        NUMBER,
+        BOOLEAN,
+        NULL_VALUE
+    };
+
+    /**
+     * @brief State of the parse.
+     */
+    enum Status
+    {
+        PARSING,
+        DONE,
+        SYNTAX_ERROR,
+        TOO_DEEP,
+        INCOMPLETE,
+        BODY_STOPPED
+    };
+
+    /**
+     * @brief Receives an event, the path where it is and its value as text ("" for the start
+     * and end of objects and arrays, "true"/"false" for BOOLEAN and "null" for NULL_VALUE).
+     */
+    typedef std::function<void(Event event, const char *path, const char *value)> Handler;
+
+    JsonParser();
+
+    void reset();
+    void onEvent(Handler handler);
+
+    bool bind(const char *path, char *target, size_t size);
+    bool bind(const char *path, int &target);
+    bool bind(const char *path, long &target);
+    bool bind(const char *path, float &target);
+    bool bind(const char *path, bool &target);
+
+    Status parse(const uint8_t *data, size_t length);
+    Status parse(const char *data);
+    Status finish();
+    Status parseBody(RequestReader &reader);
+
+    Status getStatus();
+    size_t getPosition();
+    uint32_t getAssigned();
+    bool isTruncated();
+
+private:
+    enum State
+    {
+        VALUE,              // A value (or, after '[', the end of the array)
+        KEY,                // A key (or, after '{', the end of the object)
+        COLON,              // The ':' after a key
+        NEXT,               // A ',' or the end of the container
+        STRING_CHARS,       // Inside a string
+        STRING_ESCAPE,      // After a '\' in a string
+        STRING_UNICODE,     // The 4 hex digits of a \u sequence
+        NUMBER_CHARS,       // Inside a number
+        LITERAL_CHARS,      // Inside true, false or null
+        END                 // After the document: only whitespace
+    };
+
+    enum NumberPart
+    {
+        NUMBER_SIGN,          // After the '-'
+        NUMBER_ZERO,          // A leading '0'
+        NUMBER_INTEGER,       // In the digits of the integer part
+        NUMBER_POINT,         // After the '.'
+        NUMBER_FRACTION,      // In the digits of the fraction
+        NUMBER_E,             // After the 'e' or 'E'
+        NUMBER_EXPONENT_SIGN, // After the sign of the exponent
+        NUMBER_EXPONENT       // In the digits of the exponent
+    };
+
+    enum BindingType
+    {
+        BIND_STRING,
+        BIND_INT,
+        BIND_LONG,
+        BIND_FLOAT,
+        BIND_BOOL
+    };
+
+    /**
+     * @brief Variable of the sketch that receives the value at a path.
+     */
+    struct Binding
+    {
+        const char *path;
+        void *target;
+        size_t size;
+        uint8_t type;
+    };
+
+    /**
+     * @brief Object or array being read: its kind, the length of its path and the index of its current item.
+     */
+    struct Level
+    {
+        bool array;
+        uint16_t pathLength;
+        uint32_t index;
+    };
+
+    bool addBinding(const char *path, void *target, size_t size, uint8_t type);
+    bool consume(char c);
+    bool consumeString(char c);
+    bool startValue(char c);
+    bool enterItem();
+    bool setKeyPath();
+    bool open(bool array);
+    bool close(bool array);
+    void endValue();
+    bool consumeNumber(char c);
+    bool endNumber();
+    bool fail(Status status);
+    void appendValue(const char *data, size_t length);
+    void appendCodePoint(uint32_t codePoint);
+    void flushSurrogate();
+    void emit(Event event, const char *value);
+    void assign(Event event, const char *value);
+
+    Handler _handler;
+    Binding _bindings[JSON_PARSER_MAX_BINDINGS];
+    uint8_t _numBindings;
+    uint32_t _assigned;
+
+    Status _status;
+    State _state;
+    bool _isKey;
+    size_t _position;
+
+    Level _levels[JSON_PARSER_MAX_DEPTH];
+    uint8_t _depth;
+    char _path[JSON_PARSER_PATH_SIZE];
+    uint16_t _pathLength;
+
+    char _value[JSON_PARSER_VALUE_SIZE];
+    size_t _valueLength;
+    bool _truncated;
+
+    NumberPart _numberPart;
+    const char *_literal;
+    uint8_t _literalIndex;
+    uint32_t _codePoint;
+    uint8_t _hexDigits;
+    uint16_t _highSurrogate;
+};
+
+#endif // JSON_PARSER_H
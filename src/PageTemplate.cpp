@@ -0,0 +1,149 @@
+#include "PageTemplate.h"
+
+PageTemplate::PageTemplate(const char *progmemTemplate, const char *const *names, uint8_t count)
+{
+    _template = progmemTemplate;
+    _names = names;
+    _count = count < NO_PLACEHOLDER ? count : NO_PLACEHOLDER - 1;
+    _numSegments = 0;
+    _literalLength = 0;
+    _complete = true;
+
+    scan();
+}
+
+void PageTemplate::scan()
+{
+    size_t size = strlen_P(_template);
+    size_t literalStart = 0;
+    size_t i = 0;
+
+    while (i + 1 < size)
+    {
+        if (pgm_read_byte(_template + i) != '{' || pgm_read_byte(_template + i + 1) != '{')
+        {
+            i++;
+            continue;
+        }
+
+        uint8_t placeholder;
+        size_t length = readPlaceholder(i, &placeholder);
+        if (length == 0)
+        {
+            i++; // Not one of the names: the braces are part of the text
+            continue;
+        }
+
+        // The last segment is kept for the text after the last placeholder
+        if (_numSegments == PAGE_TEMPLATE_MAX_SEGMENTS - 1)
+        {
+            _complete = false;
+            break;
+        }
+
+        Segment &segment = _segments[_numSegments++];
+        segment.offset = literalStart;
+        segment.length = i - literalStart;
+        segment.placeholder = placeholder;
+        _literalLength += segment.length;
+
+        i += length;
+        literalStart = i;
+    }
+
+    Segment &last = _segments[_numSegments++];
+    last.offset = literalStart;
+    last.length = size - literalStart;
+    last.placeholder = NO_PLACEHOLDER;
+    _literalLength += last.length;
+}
+
+size_t PageTemplate::readPlaceholder(size_t start, uint8_t *placeholder)
+{
+    // Copies the name between "{{" and "}}", if it is short enough to be one
+    char name[PAGE_TEMPLATE_NAME_SIZE + 1];
+    size_t length = 0;
+    const char *cursor = _template + start + 2;
+    while (true)
+    {
+        char c = pgm_read_byte(cursor + length);
+        if (c == '}' && pgm_read_byte(cursor + length + 1) == '}')
+        {
+            break;
+        }
+        if (c == '\0' || c == '{' || length == PAGE_TEMPLATE_NAME_SIZE)
+        {
+            return 0;
+        }
+        name[length++] = c;
+    }
+    name[length] = '\0';
+
+    for (uint8_t id = 0; id < _count; id++)
+    {
+        if (strcmp(_names[id], name) == 0)
+        {
+            *placeholder = id;
+            return length + 4;
+        }
+    }
+    return 0;
+}
+
+size_t PageTemplate::writeLiteral(Print &output, const char *data, size_t size)
+{
+    // PROGMEM cannot be read like RAM on every board: it is copied in blocks
+    uint8_t buffer[128];
+    size_t written = 0;
+    while (written < size)
+    {
+        size_t n = size - written;
+        if (n > sizeof(buffer))
+        {
+            n = sizeof(buffer);
+        }
+        memcpy_P(buffer, data + written, n);
+        if (output.write(buffer, n) != n)
+        {
+            break;
+        }
+        written += n;
+    }
+    return written;
+}
+
+size_t PageTemplate::render(Print &output, Resolver resolver)
+{
+    size_t written = 0;
+    for (uint8_t i = 0; i < _numSegments; i++)
+    {
+        const Segment &segment = _segments[i];
+        size_t n = writeLiteral(output, _template + segment.offset, segment.length);
+        written += n;
+        if (n != segment.length)
+        {
+            break; // The output failed, e.g. the client left
+        }
+
+        if (segment.placeholder != NO_PLACEHOLDER && resolver)
+        {
+            resolver(segment.placeholder, output);
+        }
+    }
+    return written;
+}
+
+bool PageTemplate::isComplete()
+{
+    return _complete;
+}
+
+uint8_t PageTemplate::getPlaceholders()
+{
+    return _numSegments - 1;
+}
+
+size_t PageTemplate::getLiteralLength()
+{
+    return _literalLength;
+}
@@ -0,0 +1,81 @@
+#ifndef PAGE_TEMPLATE_H
+#define PAGE_TEMPLATE_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Maximum number of segments of a PageTemplate (one per placeholder, plus the text after the last one).
+ */
+#ifndef PAGE_TEMPLATE_MAX_SEGMENTS
+#define PAGE_TEMPLATE_MAX_SEGMENTS 16
+#endif
+
+/**
+ * @brief Maximum length of a placeholder name, without the braces.
+ */
+#ifndef PAGE_TEMPLATE_NAME_SIZE
+#define PAGE_TEMPLATE_NAME_SIZE 32
+#endif
+
+/**
+ * @class PageTemplate
+ * @brief Page stored in PROGMEM with placeholders ("{{name}}") replaced when it is sent.
+ *
+ * The template is scanned once, when the object is built, into a table of segments: the
+ * position and length of a literal span of the template, followed by the placeholder that
+ * comes after it. Rendering writes the literal spans in blocks and calls the resolver for
+ * each placeholder, which prints its value straight into the response: the page is never
+ * copied to RAM.
+ *
+ * The placeholder names are given as a list; the resolver receives the position of the name
+ * in that list. Text between braces that is not one of the names (e.g. "{{" in a script) is
+ * left as it is. When the template has more placeholders than PAGE_TEMPLATE_MAX_SEGMENTS
+ * allows, the remaining ones are also left as they are and isComplete() returns false.
+ *
+ * render() returns the number of bytes of the template written, without the values of the
+ * placeholders; getLiteralLength() is the size of the page without its placeholders.
+ */
+class PageTemplate
+{
+public:
+    /**
+     * @brief Prints the value of the placeholder number id (position in the list of names).
+     */
+    typedef std::function<void(uint8_t id, Print &output)> Resolver;
+
+    PageTemplate(const char *progmemTemplate, const char *const *names, uint8_t count);
+
+    size_t render(Print &output, Resolver resolver);
+
+    bool isComplete();
+    uint8_t getPlaceholders();
+    size_t getLiteralLength();
+
+private:
+    /**
+     * @brief Literal span of the template and the placeholder that follows it.
+     */
+    struct Segment
+    {
+        uint32_t offset;
+        uint32_t length;
+        uint8_t placeholder;
+    };
+
+    static const uint8_t NO_PLACEHOLDER = 0xFF;
+
+    void scan();
+    size_t readPlaceholder(size_t start, uint8_t *placeholder);
+    size_t writeLiteral(Print &output, const char *data, size_t size);
+
+    const char *_template;
+    const char *const *_names;
+    uint8_t _count;
+
+    Segment _segments[PAGE_TEMPLATE_MAX_SEGMENTS];
+    uint8_t _numSegments;
+    size_t _literalLength;
+    bool _complete;
+};
+
+#endif // PAGE_TEMPLATE_H
@@ -0,0 +1,184 @@
+#include "RateLimiter.h"
+
+static const char SERVICE_UNAVAILABLE[] = "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\n"
+                                          "Content-Length: 0\r\nConnection: close\r\n\r\n";
+
+RateLimiter::RateLimiter(uint8_t burst, uint16_t refillIntervalMs)
+{
+    setRoute(_routes[0], nullptr, burst, refillIntervalMs);
+    _numRoutes = 1;
+
+    for (size_t i = 0; i < RATE_LIMITER_MAX_CLIENTS; i++)
+    {
+        _buckets[i].used = false;
+    }
+
+    _rejected = 0;
+    _shed = 0;
+    _capacityProbe = nullptr;
+    _minFree = 0;
+}
+
+void RateLimiter::setRoute(Route &route, const char *url, uint8_t burst, uint16_t refillIntervalMs)
+{
+    route.url = url;
+    route.burst = burst > 0 ? burst : 1;
+    route.refillIntervalMs = refillIntervalMs > 0 ? refillIntervalMs : 1;
+
+    // The 429 response is built once here, so a rejection is only a write; a client waits
+    // at most one refill interval for its next token
+    int len = snprintf(route.rejection, sizeof(route.rejection),
+                       "HTTP/1.1 %s\r\nRetry-After: %u\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                       StatusCode::ClientError::_429_TOO_MANY_REQUESTS, (route.refillIntervalMs + 999) / 1000);
+    route.rejectionLength = len > 0 ? len : 0;
+}
+
+bool RateLimiter::addRoute(const char *url, uint8_t burst, uint16_t refillIntervalMs)
+{
+    if (url == nullptr || _numRoutes > RATE_LIMITER_MAX_ROUTES)
+    {
+        return false;
+    }
+
+    // The URL pointer is kept, so it must remain valid (usually a string literal)
+    setRoute(_routes[_numRoutes], url, burst, refillIntervalMs);
+    _numRoutes++;
+    return true;
+}
+
+uint8_t RateLimiter::findRoute(const char *url)
+{
+    if (url != nullptr)
+    {
+        for (uint8_t i = 1; i < _numRoutes; i++)
+        {
+            if (strcmp(_routes[i].url, url) == 0)
+            {
+                return i;
+            }
+        }
+    }
+    return 0;
+}
+
+RateLimiter::Bucket *RateLimiter::findBucket(uint32_t ip, uint8_t route, uint32_t now)
+{
+    Bucket *victim = nullptr;
+
+    for (size_t i = 0; i < RATE_LIMITER_MAX_CLIENTS; i++)
+    {
+        Bucket *bucket = &_buckets[i];
+        if (!bucket->used)
+        {
+            if (victim == nullptr || victim->used)
+            {
+                victim = bucket;
+            }
+            continue;
+        }
+
+        if (bucket->ip == ip && bucket->route == route)
+        {
+            return bucket;
+        }
+
+        // Least recently seen bucket is evicted when there is no free slot
+        if (victim == nullptr || (victim->used && now - bucket->lastSeen > now - victim->lastSeen))
+        {
+            victim = bucket;
+        }
+    }
+
+    // A new (or evicted) client starts with a full bucket
+    victim->used = true;
+    victim->ip = ip;
+    victim->route = route;
+    victim->tokens = _routes[route].burst;
+    victim->lastRefill = now;
+    return victim;
+}
+
+bool RateLimiter::consume(uint32_t ip, uint8_t route)
+{
+    uint32_t now = millis();
+    const Route &budget = _routes[route];
+    Bucket *bucket = findBucket(ip, route, now);
+    bucket->lastSeen = now;
+
+    // Refill the tokens earned since the last refill
+    uint32_t elapsed = now - bucket->lastRefill;
+    if (elapsed >= budget.refillIntervalMs)
+    {
+        uint32_t earned = elapsed / budget.refillIntervalMs;
+        if (bucket->tokens + earned >= budget.burst)
+        {
+            bucket->tokens = budget.burst;
+            bucket->lastRefill = now;
+        }
+        else
+        {
+            bucket->tokens += earned;
+            bucket->lastRefill += earned * budget.refillIntervalMs;
+        }
+    }
+
+    if (bucket->tokens > 0)
+    {
+        bucket->tokens--;
+        return true;
+    }
+
+    _rejected++;
+    return false;
+}
+
+bool RateLimiter::allow(IPAddress ip, const char *url)
+{
+    return consume((uint32_t)ip, findRoute(url));
+}
+
+bool RateLimiter::check(Client &client, IPAddress ip, AnalyserRequest &request)
+{
+    uint8_t route = findRoute(request.getUrl());
+    if (consume((uint32_t)ip, route))
+    {
+        return true;
+    }
+
+    client.write((const uint8_t *)_routes[route].rejection, _routes[route].rejectionLength);
+    return false;
+}
+
+void RateLimiter::setCapacityProbe(CapacityProbe probe, uint8_t minFree)
+{
+    _capacityProbe = probe;
+    _minFree = minFree;
+}
+
+bool RateLimiter::admit(Client &client)
+{
+    if (!_capacityProbe || _capacityProbe() >= _minFree)
+    {
+        return true;
+    }
+
+    shed(client);
+    return false;
+}
+
+void RateLimiter::shed(Client &client)
+{
+    _shed++;
+    client.write((const uint8_t *)SERVICE_UNAVAILABLE, sizeof(SERVICE_UNAVAILABLE) - 1);
+}
+
+uint32_t RateLimiter::getRejected()
+{
+    return _rejected;
+}
+
+uint32_t RateLimiter::getShed()
+{
+    return _shed;
+}
+
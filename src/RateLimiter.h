@@ -0,0 +1,109 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Maximum number of (client, route) buckets tracked at the same time.
+ *
+ * When the table is full, the least recently seen bucket is evicted.
+ */
+#ifndef RATE_LIMITER_MAX_CLIENTS
+#define RATE_LIMITER_MAX_CLIENTS 16
+#endif
+
+/**
+ * @brief Maximum number of routes with their own budget (besides the default one).
+ */
+#ifndef RATE_LIMITER_MAX_ROUTES
+#define RATE_LIMITER_MAX_ROUTES 4
+#endif
+
+/**
+ * @class RateLimiter
+ * @brief Per-client token-bucket rate limiting and global load shedding.
+ *
+ * Each client (identified by its remote IP) owns a token bucket that holds at most
+ * `burst` tokens and earns one token every `refillIntervalMs` milliseconds. Every
+ * request spends one token; a request that finds the bucket empty is answered with
+ * "429 Too Many Requests". Routes registered with addRoute() get a bucket of their own,
+ * so an aggressively polled endpoint does not use the budget of the rest of the site.
+ *
+ * The bucket table has a fixed size (RATE_LIMITER_MAX_CLIENTS) and never allocates;
+ * when it is full, the least recently seen client is evicted.
+ *
+ * Load shedding is independent of the buckets: admit() asks the probe set with
+ * setCapacityProbe() how much capacity is free (e.g. the sockets of the Ethernet chip that
+ * are still closed, or idle workers) and answers "503 Service Unavailable" when less than
+ * the minimum is left, so the connection is released at once instead of being served slowly.
+ *
+ * Rejections are minimal responses (no body, with Retry-After and Connection: close) built
+ * when the limiter is configured and sent with a single write, so a rejected request costs
+ * almost nothing. The Retry-After of a 429 is the refill interval of the route, rounded up
+ * to whole seconds.
+ */
+class RateLimiter
+{
+public:
+    /**
+     * @brief Returns the free capacity of the server (e.g. number of free sockets).
+     */
+    typedef std::function<uint8_t()> CapacityProbe;
+
+    RateLimiter(uint8_t burst = 10, uint16_t refillIntervalMs = 200);
+
+    bool addRoute(const char *url, uint8_t burst, uint16_t refillIntervalMs);
+
+    bool allow(IPAddress ip, const char *url = nullptr);
+    bool check(Client &client, IPAddress ip, AnalyserRequest &request);
+
+    void setCapacityProbe(CapacityProbe probe, uint8_t minFree = 1);
+    bool admit(Client &client);
+    void shed(Client &client);
+
+    uint32_t getRejected();
+    uint32_t getShed();
+
+private:
+    /**
+     * @brief Token budget applied to a route (index 0 is the default budget) and its 429 response.
+     */
+    struct Route
+    {
+        const char *url;
+        uint8_t burst;
+        uint16_t refillIntervalMs;
+        char rejection[96];
+        uint8_t rejectionLength;
+    };
+
+    /**
+     * @brief Token bucket of a client for a given route.
+     */
+    struct Bucket
+    {
+        uint32_t ip;
+        uint8_t route;
+        uint8_t tokens;
+        bool used;
+        uint32_t lastRefill;
+        uint32_t lastSeen;
+    };
+
+    void setRoute(Route &route, const char *url, uint8_t burst, uint16_t refillIntervalMs);
+    uint8_t findRoute(const char *url);
+    Bucket *findBucket(uint32_t ip, uint8_t route, uint32_t now);
+    bool consume(uint32_t ip, uint8_t route);
+
+    Route _routes[RATE_LIMITER_MAX_ROUTES + 1];
+    uint8_t _numRoutes;
+    Bucket _buckets[RATE_LIMITER_MAX_CLIENTS];
+
+    uint32_t _rejected;
+    uint32_t _shed;
+
+    CapacityProbe _capacityProbe;
+    uint8_t _minFree;
+};
+
+#endif // RATE_LIMITER_H
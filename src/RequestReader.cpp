@@ -0,0 +1,245 @@
+#include "RequestReader.h"
+
+ConnectionTimeouts RequestReader::_timeouts = {
+    REQUEST_READER_REQUEST_LINE_TIMEOUT,
+    REQUEST_READER_HEADERS_TIMEOUT,
+    REQUEST_READER_BODY_TIMEOUT,
+    REQUEST_READER_TOTAL_TIMEOUT,
+    BUILD_RESPONSE_WRITE_TIMEOUT};
+
+ConnectionStats RequestReader::_stats = {};
+
+RequestReader::RequestReader(Client &client, AnalyserRequest &request) : _client(client), _request(request)
+{
+    _result = PENDING;
+    _start = millis();
+    _received = false;
+    _requestLineDone = false;
+    _bodyRemaining = 0;
+    _lineLength = 0;
+}
+
+void RequestReader::setTimeouts(const ConnectionTimeouts &timeouts)
+{
+    _timeouts = timeouts;
+    BuildResponse::setWriteTimeout(timeouts.writeStallMs);
+}
+
+ConnectionTimeouts RequestReader::getTimeouts()
+{
+    return _timeouts;
+}
+
+ConnectionStats RequestReader::getStats()
+{
+    ConnectionStats stats = _stats;
+    stats.writeStalls = BuildResponse::getWriteStalls();
+    return stats;
+}
+
+void RequestReader::onRequestLine(RequestLineHandler handler)
+{
+    _requestLineHandler = handler;
+}
+
+void RequestReader::onHeader(HeaderHandler handler)
+{
+    _headerHandler = handler;
+}
+
+RequestReader::Result RequestReader::getResult()
+{
+    return _result;
+}
+
+size_t RequestReader::getBodyRemaining()
+{
+    return _bodyRemaining;
+}
+
+RequestReader::Result RequestReader::fail(Result result, const char *code)
+{
+    BuildResponse response(_client, _request);
+    response.begin(code);
+    response.send();
+
+    _result = result;
+    return result;
+}
+
+RequestReader::Result RequestReader::timeout(uint32_t &counter)
+{
+    counter++;
+
+    // A connection that never sent anything (e.g. opened in advance by a browser) is just closed
+    if (!_received)
+    {
+        _result = TIMED_OUT;
+        return _result;
+    }
+    return fail(TIMED_OUT, StatusCode::ClientError::_408_REQUEST_TIMEOUT);
+}
+
+RequestReader::Result RequestReader::poll()
+{
+    if (_result != PENDING)
+    {
+        return _result;
+    }
+
+    // Everything already received is processed without waiting
+    while (_client.available() > 0)
+    {
+        int c = _client.read();
+        if (c < 0)
+        {
+            break;
+        }
+        _received = true;
+
+        if (c == '\r')
+        {
+            continue;
+        }
+
+        if (c != '\n')
+        {
+            if (_lineLength < sizeof(_line) - 1)
+            {
+                _line[_lineLength++] = c;
+                continue;
+            }
+
+            _stats.oversized++;
+            return fail(TOO_LARGE, _requestLineDone ? StatusCode::ClientError::_431_REQUEST_HEADER_FIELDS_TOO_LARGE
+                                                    : StatusCode::ClientError::_414_URI_TOO_LONG);
+        }
+
+        if (_lineLength == 0)
+        {
+            if (!_requestLineDone)
+            {
+                continue; // Empty lines before the request line are ignored
+            }
+
+            // End of the headers
+            _stats.requests++;
+            _bodyRemaining = _request.getContentLength();
+            _result = READY;
+            return _result;
+        }
+
+        _line[_lineLength] = '\0';
+        _lineLength = 0;
+        Header header = _request.analyzeHttpLine(_line);
+
+        if (!_requestLineDone)
+        {
+            _requestLineDone = true;
+            if (_request.isMalformed())
+            {
+                _stats.malformed++;
+                return fail(MALFORMED, StatusCode::ClientError::_400_BAD_REQUEST);
+            }
+            if (_requestLineHandler && !_requestLineHandler(_client, _request))
+            {
+                _stats.rejected++;
+                _result = REJECTED;
+                return _result;
+            }
+        }
+        else if (header.key[0] != '\0' && _headerHandler)
+        {
+            _headerHandler(header);
+        }
+    }
+
+    if (!_client.connected())
+    {
+        if (_received)
+        {
+            _stats.closedEarly++;
+        }
+        _result = CLOSED;
+        return _result;
+    }
+
+    uint32_t elapsed = millis() - _start;
+    if (!_requestLineDone && elapsed >= _timeouts.requestLineMs)
+    {
+        return timeout(_stats.requestLineTimeouts);
+    }
+    if (elapsed >= _timeouts.headersMs)
+    {
+        return timeout(_stats.headerTimeouts);
+    }
+    if (elapsed >= _timeouts.totalMs)
+    {
+        return timeout(_stats.totalTimeouts);
+    }
+    return PENDING;
+}
+
+RequestReader::Result RequestReader::read()
+{
+    Result result;
+    while ((result = poll()) == PENDING)
+    {
+        yield();
+    }
+    return result;
+}
+
+size_t RequestReader::readBody(uint8_t *buffer, size_t size)
+{
+    if (_result != READY)
+    {
+        return 0;
+    }
+
+    if (size > _bodyRemaining)
+    {
+        size = _bodyRemaining;
+    }
+
+    size_t filled = 0;
+    uint32_t lastData = millis();
+    while (filled < size)
+    {
+        int available = _client.available();
+        if (available > 0)
+        {
+            size_t n = size - filled < (size_t)available ? size - filled : (size_t)available;
+            int bytesRead = _client.read(buffer + filled, n);
+            if (bytesRead > 0)
+            {
+                filled += bytesRead;
+                lastData = millis();
+                continue;
+            }
+        }
+
+        if (!_client.connected())
+        {
+            _stats.closedEarly++;
+            _result = CLOSED;
+            break;
+        }
+
+        uint32_t now = millis();
+        if (now - lastData >= _timeouts.bodyIdleMs)
+        {
+            timeout(_stats.bodyTimeouts);
+            break;
+        }
+        if (now - _start >= _timeouts.totalMs)
+        {
+            timeout(_stats.totalTimeouts);
+            break;
+        }
+        yield();
+    }
+
+    _bodyRemaining -= filled;
+    return filled;
+}
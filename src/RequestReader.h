@@ -0,0 +1,166 @@
+#ifndef REQUEST_READER_H
+#define REQUEST_READER_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Maximum length of the request line and of each header line.
+ *
+ * 640 is the sum of the Key (128) and Value (512) of a custom header. Longer lines are
+ * answered with "414 URI Too Long" (request line) or "431 Request Header Fields Too Large".
+ */
+#ifndef REQUEST_READER_LINE_SIZE
+#define REQUEST_READER_LINE_SIZE 640
+#endif
+
+/**
+ * @brief Default time (in milliseconds) allowed to receive the request line.
+ */
+#ifndef REQUEST_READER_REQUEST_LINE_TIMEOUT
+#define REQUEST_READER_REQUEST_LINE_TIMEOUT 5000
+#endif
+
+/**
+ * @brief Default time (in milliseconds) allowed to receive the request line and all the headers.
+ */
+#ifndef REQUEST_READER_HEADERS_TIMEOUT
+#define REQUEST_READER_HEADERS_TIMEOUT 10000
+#endif
+
+/**
+ * @brief Default time (in milliseconds) the body may stay without receiving any data.
+ */
+#ifndef REQUEST_READER_BODY_TIMEOUT
+#define REQUEST_READER_BODY_TIMEOUT 5000
+#endif
+
+/**
+ * @brief Default time (in milliseconds) allowed to receive the whole request, body included.
+ */
+#ifndef REQUEST_READER_TOTAL_TIMEOUT
+#define REQUEST_READER_TOTAL_TIMEOUT 30000
+#endif
+
+/**
+ * @brief Deadlines applied to every connection, all in milliseconds.
+ *
+ * The request line, headers and total deadlines count from the moment the connection is
+ * handed to the RequestReader, so a client cannot extend them by sending one byte at a time.
+ * The body deadline is an inactivity timeout, and the write stall deadline limits how long a
+ * response waits for a client that stopped reading.
+ */
+struct ConnectionTimeouts
+{
+    uint32_t requestLineMs;
+    uint32_t headersMs;
+    uint32_t bodyIdleMs;
+    uint32_t totalMs;
+    uint32_t writeStallMs;
+};
+
+/**
+ * @brief Counters of the requests read and of the ways connections ended early.
+ */
+struct ConnectionStats
+{
+    uint32_t requests;
+    uint32_t requestLineTimeouts;
+    uint32_t headerTimeouts;
+    uint32_t bodyTimeouts;
+    uint32_t totalTimeouts;
+    uint32_t writeStalls;
+    uint32_t closedEarly;
+    uint32_t oversized;
+    uint32_t malformed;
+    uint32_t rejected;
+};
+
+/**
+ * @class RequestReader
+ * @brief Reads a request from a connection while enforcing deadlines.
+ *
+ * Replaces the `while (client.connected())` loop of the sketches: the request line and the
+ * headers are read and passed to AnalyserRequest, and readBody() reads the body. When a
+ * deadline expires the client gets "408 Request Timeout" (or nothing, when it never sent a
+ * byte) and the reading stops, so a slow or silent client holds the server, and one of the
+ * sockets of the Ethernet chip, for a bounded time only.
+ *
+ * readBody() returns 0 at the end of the body, but also when the body stops coming: the
+ * reader has then already answered (or the client left) and getResult() is no longer READY.
+ * A handler checks getResult() after reading the body and only sends its own response when
+ * it is still READY.
+ *
+ * poll() never waits: it processes what was already received and returns PENDING until the
+ * headers are complete, which lets a sketch serve several connections in turns. read() waits
+ * for the headers, still within the deadlines.
+ *
+ * The deadlines and the counters are shared by all the connections; setTimeouts() also sets
+ * the write stall timeout of BuildResponse.
+ */
+class RequestReader
+{
+public:
+    /**
+     * @brief State of the request.
+     */
+    enum Result
+    {
+        PENDING,
+        READY,
+        CLOSED,
+        TIMED_OUT,
+        TOO_LARGE,
+        MALFORMED,
+        REJECTED
+    };
+
+    /**
+     * @brief Handler called right after the request line; returning false rejects the request.
+     *
+     * The handler answers the rejected request itself (e.g. RateLimiter::check()).
+     */
+    typedef std::function<bool(Client &client, AnalyserRequest &request)> RequestLineHandler;
+
+    /**
+     * @brief Handler called with each header not handled by AnalyserRequest.
+     */
+    typedef std::function<void(const Header &header)> HeaderHandler;
+
+    RequestReader(Client &client, AnalyserRequest &request);
+
+    void onRequestLine(RequestLineHandler handler);
+    void onHeader(HeaderHandler handler);
+
+    Result poll();
+    Result read();
+    size_t readBody(uint8_t *buffer, size_t size);
+    size_t getBodyRemaining();
+    Result getResult();
+
+    static void setTimeouts(const ConnectionTimeouts &timeouts);
+    static ConnectionTimeouts getTimeouts();
+    static ConnectionStats getStats();
+
+private:
+    Result fail(Result result, const char *code);
+    Result timeout(uint32_t &counter);
+
+    Client &_client;
+    AnalyserRequest &_request;
+    RequestLineHandler _requestLineHandler;
+    HeaderHandler _headerHandler;
+
+    Result _result;
+    uint32_t _start;
+    bool _received;
+    bool _requestLineDone;
+    size_t _bodyRemaining;
+
+    char _line[REQUEST_READER_LINE_SIZE];
+    size_t _lineLength;
+
+    static ConnectionTimeouts _timeouts;
+    static ConnectionStats _stats;
+};
+
+#endif // REQUEST_READER_H
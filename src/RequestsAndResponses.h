@@ -3,6 +3,27 @@
 
 #include <Arduino.h>
 #include <FS.h>
+#include "GzipEncoder.h"
+
+class PageTemplate;
+class FileCache;
+
+/**
+ * @brief Size (in bytes) of the buffer where BuildResponse gathers the status line and headers.
+ *
+ * The header block is sent in a single write when the body starts. Headers that do not fit
+ * are still sent, in more than one write.
+ */
+#ifndef BUILD_RESPONSE_HEADER_SIZE
+#define BUILD_RESPONSE_HEADER_SIZE 256
+#endif
+
+/**
+ * @brief Default time (in milliseconds) a response waits for a client that does not read what is sent.
+ */
+#ifndef BUILD_RESPONSE_WRITE_TIMEOUT
+#define BUILD_RESPONSE_WRITE_TIMEOUT 5000
+#endif
 
 /**
  * @enum MethodsHttp
@@ -47,9 +68,38 @@ enum MethodsHttp
      *
      * The DELETE method deletes the specified resource.
      */
-    DELETE
+    DELETE,
+
+    /**
+     * @brief Represents the HTTP HEAD method.
+     *
+     * The HEAD method asks for a response identical to a GET request, but
+     * without the response body. BuildResponse omits the body automatically
+     * when it is built with the request.
+     */
+    HEAD,
+
+    /**
+     * @brief Represents the HTTP OPTIONS method.
+     *
+     * The OPTIONS method requests the communication options available for
+     * the target resource.
+     */
+    OPTIONS,
+
+    /**
+     * @brief Represents the HTTP PATCH method.
+     *
+     * The PATCH method applies partial modifications to a resource.
+     */
+    PATCH
 };
 
+/**
+ * @brief Returns the name of an HTTP method ("GET", "POST", ...), or "Unknown".
+ */
+const char *methodName(MethodsHttp method);
+
 /**
  * @brief Represents an HTTP header.
  *
@@ -109,6 +159,7 @@ namespace ContentType
     const char APPLICATION_XML[] = "application/xml";
     const char APPLICATION_X_WWW_FORM_URLENCODED[] = "application/x-www-form-urlencoded";
     const char MULTIPART_FORM_DATA[] = "multipart/form-data";
+    const char TEXT_EVENT_STREAM[] = "text/event-stream";
 }
 
 /**
@@ -305,6 +356,14 @@ namespace StatusCode
          */
         const char _405_METHOD_NOT_ALLOWED[] = "405 Method Not Allowed";
 
+        /**
+         * @brief HTTP status code for a request that was not received completely in time.
+         *
+         * This constant represents the "408 Request Timeout" status code, indicating that
+         * the server did not receive a complete request within the time it was prepared to wait.
+         */
+        const char _408_REQUEST_TIMEOUT[] = "408 Request Timeout";
+
         /**
          * @brief HTTP status code for a request that could not be processed because of a conflict.
          *
@@ -363,6 +422,15 @@ namespace StatusCode
          */
         const char _423_LOCKED[] = "423 Locked";
 
+        /**
+         * @brief HTTP status code for a request that must be repeated using a different protocol.
+         *
+         * This constant represents the "426 Upgrade Required" status code, indicating that
+         * the server refuses to perform the request using the current protocol, but might do so
+         * after the client upgrades to the protocol given in the Upgrade (or Sec-WebSocket-Version) header.
+         */
+        const char _426_UPGRADE_REQUIRED[] = "426 Upgrade Required";
+
         /**
          * @brief HTTP status code for a request that has been made too many times in a given amount of time.
          *
@@ -440,6 +508,9 @@ public:
     AnalyserRequest();
     Header analyzeHttpLine(const char *line);
 
+    bool isMalformed();
+    const char *getHttpVersion();
+    bool isHttp11();
     const char *getMethod();
     bool methodIs(MethodsHttp method);
     const char *getUrl();
@@ -454,8 +525,24 @@ public:
     const char *getCookie(const char *cookie);
     const char *getCookies();
     const char *getUserAgent();
+    const char *getAcceptEncoding();
+    bool acceptsEncoding(const char *encoding);
+    const char *getUpgrade();
+    const char *getConnection();
+    const char *getWebSocketKey();
+    int getWebSocketVersion();
+    const char *getLastEventId();
+    bool expectsContinue();
+    const char *getContentDigest();
+    const char *getIfNoneMatch();
 
 private:
+    bool parseRequestLine(const char *line);
+
+    bool _requestLineParsed;
+    bool _malformed;
+    uint8_t _httpMinorVersion;
+
     char _host[128] = "";
     int _numHeadersCustom;
     MethodsHttp _method;
@@ -466,11 +553,41 @@ private:
     char _authorization[256] = "";
     char _cookie[512] = "";
     char _userAgent[128] = "";
+    char _acceptEncoding[64] = "";
+    char _upgrade[32] = "";
+    char _connection[64] = "";
+    char _webSocketKey[32] = "";
+    int _webSocketVersion;
+    char _lastEventId[16] = "";
+    bool _expectContinue;
+    char _contentDigest[96] = "";
+    char _ifNoneMatch[96] = "";
 
     char *_params;
     bool _haveParameters;
 };
 
+/**
+ * @brief Platform hook that sends the body of a file straight from the file to the connection.
+ *
+ * BuildResponse::send(contentType, fs, path) calls it before falling back to its portable
+ * loop, which copies the file through a buffer. The library only provides a weak version that
+ * returns false; a platform where the client is a real socket and the file a real descriptor
+ * (e.g. the Linux host build in extras/host, with sendfile() or mmap() and writev()) defines
+ * its own to avoid the copies.
+ *
+ * @param client Connection of the response.
+ * @param file File to send, from its current position.
+ * @param head Status line and headers not sent yet, to send before the body (may be empty).
+ * @param headLength Number of bytes of head.
+ * @param size Number of bytes of the file to send.
+ * @param timeoutMs Time the connection may go without accepting data before the transfer is abandoned.
+ * @param sent Receives the number of bytes of the body sent.
+ * @return false when the hook cannot send this file on this connection (nothing was sent),
+ * true when it took care of the transfer (complete when *sent equals size).
+ */
+bool sendFileNative(Client &client, fs::File &file, const uint8_t *head, size_t headLength, size_t size, uint32_t timeoutMs, size_t *sent);
+
 /**
  * @class BuildResponse
  * @brief A class to build and send HTTP responses.
@@ -478,12 +595,35 @@ private:
  * This class provides methods to construct and send HTTP responses to a client.
  * It allows setting the response code, adding headers, and sending the response
  * message with optional content type and length.
+ *
+ * When built with the request, a response to a HEAD request is sent without its body,
+ * and chunked transfer encoding is avoided for HTTP/1.0 clients.
+ *
+ * The status line and headers are gathered in a buffer and sent together with the
+ * start of the body. The response is finished by end(), which is also called when the
+ * object goes out of scope. Responses that keep the connection open (protocol upgrades,
+ * event streams) finish their headers with openStream() instead of send().
+ *
+ * Content in PROGMEM is sent in blocks. A PageTemplate is sent without copying the page to
+ * RAM: its literal spans and the values printed by the resolver are gathered in a
+ * BufferedWriter before they reach the connection. Files found in a FileCache are sent from
+ * memory, with their Content-Length and ETag headers; when the response was built with the
+ * request and begun with "200 OK", a request whose If-None-Match names that ETag gets
+ * "304 Not Modified" instead, without the body. Other files are handed to sendFileNative()
+ * first, which the platform may implement without copies.
+ *
+ * A client that stops reading cannot block the server: when no data could be written for
+ * the write timeout (BUILD_RESPONSE_WRITE_TIMEOUT, or setWriteTimeout()), the connection is
+ * closed and the rest of the response is discarded.
  */
 class BuildResponse
 {
 public:
     BuildResponse(Client &client);
+    BuildResponse(Client &client, AnalyserRequest &request);
+    ~BuildResponse();
     void begin(const char *code);
+    void enableCompression(GzipEncoder &encoder, AnalyserRequest &request, size_t threshold = 256);
     void addHeader(const char *key, const char *value);
 
     void send(const char *message, bool newLine = true);
@@ -491,11 +631,80 @@ public:
     void send(const char *contentType, const uint8_t *contentGzip, uint32_t size, std::function<void()> callback = nullptr);
     void send(const char *contentType, const char *progmemContent, size_t size);
     void send(const char *contentType, fs::FS &fs, const char *path);
+    void send(const char *contentType, FileCache &cache, fs::FS &fs, const char *path);
+    void send(const char *contentType, PageTemplate &page, std::function<void(uint8_t id, Print &output)> resolver);
     void send();
+    void openStream(const char *contentType = nullptr);
+    void end();
+    bool stalled();
+
+    static void setWriteTimeout(uint32_t timeoutMs);
+    static uint32_t getWriteStalls();
 
 private:
+    /**
+     * @brief Print that writes to the body of the response (used to render templates).
+     */
+    class BodyWriter : public Print
+    {
+    public:
+        BodyWriter(BuildResponse &response);
+
+        size_t write(uint8_t byte) override;
+        size_t write(const uint8_t *data, size_t size) override;
+        using Print::write;
+
+    private:
+        BuildResponse &_response;
+    };
+
+    void appendHead(const char *text);
+    void flushHead();
+    void writeHeaders(const char *contentType, size_t bodyLength, bool exactLength = false);
+    void sendFile(const char *contentType, File &file);
+    bool replaceStatus(const char *expected, const char *code);
+    void writeBody(const uint8_t *data, size_t size);
+    void writeProgmem(const uint8_t *data, size_t size, std::function<void()> callback = nullptr);
+    void writeChunk(const uint8_t *data, size_t size);
+    void writeEncoded(const uint8_t *data, size_t size);
+    void writeRaw(const uint8_t *data, size_t size);
+    void writeClient(const uint8_t *data, size_t size);
+    void abandon();
+
     Client *_client;
     bool _alreadyClosed = false;
+    bool _ended = false;
+
+    char _head[BUILD_RESPONSE_HEADER_SIZE];
+    size_t _headLength = 0;
+
+    bool _omitBody = false;
+    bool _http10 = false;
+    const char *_ifNoneMatch = "";
+
+    GzipEncoder *_encoder = nullptr;
+    size_t _compressionThreshold = 0;
+    bool _compressing = false;
+    bool _chunked = false;
+
+    bool _reportsRoom = false;
+    bool _stalled = false;
+
+    static uint32_t _writeTimeoutMs;
+    static uint32_t _writeStalls;
 };
 
+#include "RateLimiter.h"
+#include "ResponseCache.h"
+#include "Digest.h"
+#include "WebSocket.h"
+#include "EventSource.h"
+#include "UploadEngine.h"
+#include "HttpClient.h"
+#include "RequestReader.h"
+#include "PageTemplate.h"
+#include "FileCache.h"
+#include "AccessLog.h"
+#include "JsonParser.h"
+
 #endif // HTTPPARSER_H
\ No newline at end of file
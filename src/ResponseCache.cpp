@@ -0,0 +1,347 @@
+#include "ResponseCache.h"
+
+ResponseCache::ResponseCache(uint8_t *pool, size_t poolSize, uint8_t entries)
+{
+    if (entries == 0 || entries > RESPONSE_CACHE_MAX_ENTRIES)
+    {
+        entries = RESPONSE_CACHE_MAX_ENTRIES;
+    }
+
+    _pool = pool;
+    _numEntries = pool != nullptr ? entries : 0;
+    _slotSize = pool != nullptr ? poolSize / entries : 0;
+    _hand = 0;
+    _hits = 0;
+    _misses = 0;
+
+    clear();
+}
+
+size_t ResponseCache::buildKey(char *key, size_t size, AnalyserRequest &request, const char *variant)
+{
+    // The query string is part of the key: "/x?a=1" and "/x?a=2" are different responses
+    const char *params = request.getParams();
+    const char *separator = params[0] != '\0' ? "?" : "";
+
+    int len;
+    if (variant != nullptr)
+    {
+        len = snprintf(key, size, "%s %s%s%s\n%s", request.getMethod(), request.getUrl(), separator, params, variant);
+    }
+    else
+    {
+        len = snprintf(key, size, "%s %s%s%s", request.getMethod(), request.getUrl(), separator, params);
+    }
+
+    if (len < 0 || (size_t)len >= size)
+    {
+        return 0; // Key too long to be cached
+    }
+    return len;
+}
+
+uint32_t ResponseCache::hashKey(const char *key, size_t length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint8_t *ResponseCache::slot(int index)
+{
+    return _pool + (size_t)index * _slotSize;
+}
+
+int ResponseCache::find(const char *key, size_t keyLength, uint32_t hash)
+{
+    for (uint8_t i = 0; i < _numEntries; i++)
+    {
+        Entry &entry = _entries[i];
+        if (entry.used && entry.hash == hash && entry.keyLength == keyLength && memcmp(slot(i), key, keyLength) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ResponseCache::reserve()
+{
+    if (_numEntries == 0)
+    {
+        return -1;
+    }
+
+    // CLOCK: entries referenced since the last pass get a second chance
+    for (uint16_t step = 0; step < 2 * _numEntries; step++)
+    {
+        uint8_t index = _hand;
+        _hand = (_hand + 1) % _numEntries;
+
+        Entry &entry = _entries[index];
+        if (entry.used && entry.referenced)
+        {
+            entry.referenced = false;
+            continue;
+        }
+
+        entry.used = false;
+        return index;
+    }
+    return -1;
+}
+
+bool ResponseCache::serve(Client &client, AnalyserRequest &request, const char *variant)
+{
+    char key[640];
+    size_t keyLength = buildKey(key, sizeof(key), request, variant);
+    int index = keyLength > 0 ? find(key, keyLength, hashKey(key, keyLength)) : -1;
+
+    if (index < 0)
+    {
+        _misses++;
+        return false;
+    }
+
+    Entry &entry = _entries[index];
+    if ((int32_t)(millis() - entry.expires) >= 0)
+    {
+        entry.used = false; // Expired
+        _misses++;
+        return false;
+    }
+
+    entry.referenced = true;
+    _hits++;
+
+    // The stored bytes are the complete response; a connection that accepts only part of them
+    // gets the rest as it makes room, until it stops reading for the write stall deadline
+    const uint8_t *data = slot(index) + entry.keyLength;
+    size_t size = entry.length - entry.keyLength;
+    uint32_t stallMs = RequestReader::getTimeouts().writeStallMs;
+    uint32_t lastProgress = millis();
+    while (size > 0)
+    {
+        size_t written = client.write(data, size);
+        if (written > 0)
+        {
+            data += written;
+            size -= written;
+            lastProgress = millis();
+            continue;
+        }
+        if (!client.connected() || millis() - lastProgress >= stallMs)
+        {
+            client.stop();
+            break;
+        }
+        yield();
+    }
+    return true;
+}
+
+void ResponseCache::invalidate(const char *url)
+{
+    size_t urlLength = strlen(url);
+
+    for (uint8_t i = 0; i < _numEntries; i++)
+    {
+        Entry &entry = _entries[i];
+        if (!entry.used)
+        {
+            continue;
+        }
+
+        // Keys have the form "<method> <url>[?<query>][\n<variant>]": every query of the URL is removed
+        const char *key = (const char *)slot(i);
+        const char *keyUrl = (const char *)memchr(key, ' ', entry.keyLength);
+        if (keyUrl == nullptr)
+        {
+            continue;
+        }
+        keyUrl++;
+
+        size_t remaining = entry.keyLength - (keyUrl - key);
+        if (remaining >= urlLength && memcmp(keyUrl, url, urlLength) == 0 &&
+            (remaining == urlLength || keyUrl[urlLength] == '\n' || keyUrl[urlLength] == '?'))
+        {
+            entry.used = false;
+        }
+    }
+}
+
+void ResponseCache::clear()
+{
+    for (uint8_t i = 0; i < RESPONSE_CACHE_MAX_ENTRIES; i++)
+    {
+        _entries[i].used = false;
+        _entries[i].referenced = false;
+    }
+}
+
+uint32_t ResponseCache::getHits()
+{
+    return _hits;
+}
+
+uint32_t ResponseCache::getMisses()
+{
+    return _misses;
+}
+
+ResponseCache::Recorder::Recorder(ResponseCache &cache, Client &client, AnalyserRequest &request, uint32_t ttlMs, const char *variant)
+{
+    _cache = &cache;
+    _client = &client;
+    _ttlMs = ttlMs;
+    _length = 0;
+    _overflow = true;
+    _slot = -1;
+
+    char key[640];
+    _keyLength = buildKey(key, sizeof(key), request, variant);
+    if (_keyLength == 0 || _keyLength >= cache._slotSize)
+    {
+        return;
+    }
+    _hash = hashKey(key, _keyLength);
+
+    // A stale entry with the same key is overwritten, otherwise a slot is taken from the clock
+    _slot = cache.find(key, _keyLength, _hash);
+    if (_slot >= 0)
+    {
+        cache._entries[_slot].used = false;
+    }
+    else
+    {
+        _slot = cache.reserve();
+    }
+
+    if (_slot >= 0)
+    {
+        memcpy(cache.slot(_slot), key, _keyLength);
+        _length = _keyLength;
+        _overflow = false;
+    }
+}
+
+ResponseCache::Recorder::~Recorder()
+{
+    commit();
+}
+
+bool ResponseCache::Recorder::commit()
+{
+    if (_overflow || _slot < 0 || _length == _keyLength)
+    {
+        _slot = -1;
+        return false;
+    }
+
+    Entry &entry = _cache->_entries[_slot];
+    entry.hash = _hash;
+    entry.keyLength = _keyLength;
+    entry.length = _length;
+    entry.expires = millis() + _ttlMs;
+    entry.referenced = false;
+    entry.used = true;
+
+    _slot = -1;
+    return true;
+}
+
+void ResponseCache::Recorder::discard()
+{
+    _overflow = true;
+}
+
+size_t ResponseCache::Recorder::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+size_t ResponseCache::Recorder::write(const uint8_t *buffer, size_t size)
+{
+    // Only what the client accepted is copied: the rest is written again by the caller
+    size_t written = _client->write(buffer, size);
+    if (written < size && !_client->connected())
+    {
+        _overflow = true; // The client is gone: the response was not written in full
+    }
+
+    if (!_overflow && _slot >= 0)
+    {
+        if (_length + written <= _cache->_slotSize)
+        {
+            memcpy(_cache->slot(_slot) + _length, buffer, written);
+            _length += written;
+        }
+        else
+        {
+            _overflow = true; // Too big for a slot: the response is only forwarded
+        }
+    }
+
+    return written;
+}
+
+int ResponseCache::Recorder::availableForWrite()
+{
+    return _client->availableForWrite();
+}
+
+int ResponseCache::Recorder::connect(IPAddress ip, uint16_t port)
+{
+    return _client->connect(ip, port);
+}
+
+int ResponseCache::Recorder::connect(const char *host, uint16_t port)
+{
+    return _client->connect(host, port);
+}
+
+int ResponseCache::Recorder::available()
+{
+    return _client->available();
+}
+
+int ResponseCache::Recorder::read()
+{
+    return _client->read();
+}
+
+int ResponseCache::Recorder::read(uint8_t *buffer, size_t size)
+{
+    return _client->read(buffer, size);
+}
+
+int ResponseCache::Recorder::peek()
+{
+    return _client->peek();
+}
+
+void ResponseCache::Recorder::flush()
+{
+    _client->flush();
+}
+
+void ResponseCache::Recorder::stop()
+{
+    _overflow = true; // Closed before the end (e.g. a write stall): only a complete response is kept
+    _client->stop();
+}
+
+uint8_t ResponseCache::Recorder::connected()
+{
+    return _client->connected();
+}
+
+ResponseCache::Recorder::operator bool()
+{
+    return (bool)*_client;
+}
@@ -0,0 +1,126 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Maximum number of entries a ResponseCache can hold.
+ *
+ * The pool given to the cache is split into this many slots of the same size.
+ */
+#ifndef RESPONSE_CACHE_MAX_ENTRIES
+#define RESPONSE_CACHE_MAX_ENTRIES 8
+#endif
+
+/**
+ * @class ResponseCache
+ * @brief Cache of complete, already serialised HTTP responses.
+ *
+ * Responses are stored byte for byte (status line, headers and body) in a pool of memory
+ * provided by the sketch, which may live in RAM or PSRAM. Each entry is keyed by method and
+ * URL with its query string, optionally followed by a variant string (for example the value
+ * of a header the response depends on), and expires after the TTL chosen when it was
+ * recorded. invalidate() removes the entries of a URL whatever their query string.
+ *
+ * A hit is written to the client straight from the pool, without running the handler again.
+ * When the pool is full, entries are replaced following the CLOCK policy (an approximation
+ * of LRU that only needs one reference bit per entry).
+ *
+ * Usage:
+ * @code
+ * if (!cache.serve(client, request))
+ * {
+ *     ResponseCache::Recorder recorder(cache, client, request, 2000); // Keep it for 2 seconds
+ *     BuildResponse response(recorder);
+ *     response.begin(StatusCode::Successful::_200_OK);
+ *     response.send(ContentType::APPLICATION_JSON, "{\"version\":\"0.0.1\"}");
+ * } // The response is stored when the recorder goes out of scope
+ * @endcode
+ */
+class ResponseCache
+{
+public:
+    /**
+     * @class Recorder
+     * @brief Client wrapper that forwards a response to the client while copying it into the cache.
+     *
+     * The copy is stored when commit() is called or when the recorder is destroyed. Responses
+     * that do not fit in a slot are still sent to the client, but are not cached, and so are
+     * responses that were not written in full (the connection was stopped, e.g. after a write
+     * stall, or the client went away).
+     */
+    class Recorder : public Client
+    {
+    public:
+        Recorder(ResponseCache &cache, Client &client, AnalyserRequest &request, uint32_t ttlMs, const char *variant = nullptr);
+        ~Recorder();
+
+        bool commit();
+        void discard();
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(const char *host, uint16_t port) override;
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t *buffer, size_t size) override;
+        int availableForWrite() override;
+        int available() override;
+        int read() override;
+        int read(uint8_t *buffer, size_t size) override;
+        int peek() override;
+        void flush() override;
+        void stop() override;
+        uint8_t connected() override;
+        operator bool() override;
+
+    private:
+        ResponseCache *_cache;
+        Client *_client;
+        int _slot;
+        size_t _length;
+        size_t _keyLength;
+        uint32_t _hash;
+        uint32_t _ttlMs;
+        bool _overflow;
+    };
+
+    ResponseCache(uint8_t *pool, size_t poolSize, uint8_t entries = RESPONSE_CACHE_MAX_ENTRIES);
+
+    bool serve(Client &client, AnalyserRequest &request, const char *variant = nullptr);
+    void invalidate(const char *url);
+    void clear();
+
+    uint32_t getHits();
+    uint32_t getMisses();
+
+private:
+    /**
+     * @brief Metadata of a slot. The key is stored at the beginning of the slot, followed by the response.
+     */
+    struct Entry
+    {
+        uint32_t hash;
+        uint32_t expires;
+        size_t keyLength;
+        size_t length;
+        bool used;
+        bool referenced;
+    };
+
+    static size_t buildKey(char *key, size_t size, AnalyserRequest &request, const char *variant);
+    static uint32_t hashKey(const char *key, size_t length);
+
+    int find(const char *key, size_t keyLength, uint32_t hash);
+    int reserve();
+    uint8_t *slot(int index);
+
+    uint8_t *_pool;
+    size_t _slotSize;
+    uint8_t _numEntries;
+    uint8_t _hand;
+    Entry _entries[RESPONSE_CACHE_MAX_ENTRIES];
+
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif // RESPONSE_CACHE_H
@@ -0,0 +1,481 @@
+#include "UploadEngine.h"
+
+#if defined(ESP32)
+UpdateSink::UpdateSink(int command)
+{
+    _command = command;
+}
+
+bool UpdateSink::begin(size_t size)
+{
+    return Update.begin(size, _command);
+}
+
+size_t UpdateSink::write(const uint8_t *data, size_t size)
+{
+    return Update.write((uint8_t *)data, size);
+}
+
+bool UpdateSink::end()
+{
+    return Update.end(); // Fails if fewer bytes than announced were written
+}
+
+void UpdateSink::abort()
+{
+    Update.abort();
+}
+
+const char *UpdateSink::errorString()
+{
+    return Update.errorString();
+}
+#endif
+
+FileSink::FileSink(fs::FS &fs, const char *path, size_t maxSize) : _fs(fs)
+{
+    _path = path;
+    _maxSize = maxSize;
+    _error = "";
+}
+
+bool FileSink::begin(size_t size)
+{
+    if (_maxSize > 0 && size > _maxSize)
+    {
+        _error = "Not enough space";
+        return false;
+    }
+
+    _file = _fs.open(_path, "w");
+    if (!_file)
+    {
+        _error = "Unable to create the file";
+        return false;
+    }
+    return true;
+}
+
+size_t FileSink::write(const uint8_t *data, size_t size)
+{
+    size_t written = _file.write(data, size);
+    if (written != size)
+    {
+        _error = "Error writing the file";
+    }
+    return written;
+}
+
+bool FileSink::end()
+{
+    _file.close();
+    return true;
+}
+
+void FileSink::abort()
+{
+    _file.close();
+    _fs.remove(_path);
+}
+
+const char *FileSink::errorString()
+{
+    return _error;
+}
+
+UploadEngine::UploadEngine(UploadSink &sink) : _sink(sink)
+{
+    _progressIntervalMs = 500;
+    _timeoutMs = 10000;
+    _writeFailed = false;
+    _hasExpectedDigest = false;
+    _result = COMPLETED;
+    _received = 0;
+    memset(_digest, 0, sizeof(_digest));
+}
+
+void UploadEngine::onProgress(ProgressHandler handler, uint32_t intervalMs)
+{
+    _progressHandler = handler;
+    _progressIntervalMs = intervalMs;
+}
+
+void UploadEngine::setTimeout(uint32_t timeoutMs)
+{
+    _timeoutMs = timeoutMs;
+}
+
+UploadEngine::Result UploadEngine::getResult()
+{
+    return _result;
+}
+
+size_t UploadEngine::getReceived()
+{
+    return _received;
+}
+
+void UploadEngine::getDigest(uint8_t digest[32])
+{
+    memcpy(digest, _digest, sizeof(_digest));
+}
+
+const char *UploadEngine::errorString()
+{
+    switch (_result)
+    {
+    case COMPLETED:
+        return "Upload completed";
+    case LENGTH_REQUIRED:
+        return "Content-Length not found or invalid";
+    case INVALID_DIGEST:
+        return "Invalid SHA-256 digest header";
+    case TIMED_OUT:
+        return "Upload timed out";
+    case DISCONNECTED:
+        return "Connection closed during the upload";
+    case DIGEST_MISMATCH:
+        return "SHA-256 of the upload does not match the digest header";
+    default:
+        return _sink.errorString(); // NO_SPACE, WRITE_FAILED and END_FAILED come from the sink
+    }
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool UploadEngine::parseDigest(const char *value)
+{
+    // Hexadecimal hash (X-SHA256)
+    if (strlen(value) == 2 * sizeof(_expectedDigest))
+    {
+        size_t i = 0;
+        for (; i < sizeof(_expectedDigest); i++)
+        {
+            int high = hexValue(value[2 * i]);
+            int low = hexValue(value[2 * i + 1]);
+            if (high < 0 || low < 0)
+            {
+                break;
+            }
+            _expectedDigest[i] = (high << 4) | low;
+        }
+        if (i == sizeof(_expectedDigest))
+        {
+            return true;
+        }
+    }
+
+    // List of algorithms: "sha-256=:<base64>:" (RFC 9530) or "SHA-256=<base64>" (RFC 3230)
+    const char *item = value;
+    while (item != NULL)
+    {
+        while (*item == ' ')
+        {
+            item++;
+        }
+
+        if (strncasecmp(item, "sha-256=", 8) == 0)
+        {
+            char text[48];
+            size_t length = 0;
+            for (item += 8; *item != '\0' && *item != ',' && length < sizeof(text) - 1; item++)
+            {
+                if (*item != ':' && *item != ' ')
+                {
+                    text[length++] = *item;
+                }
+            }
+            text[length] = '\0';
+            return base64Decode(text, _expectedDigest, sizeof(_expectedDigest)) == sizeof(_expectedDigest);
+        }
+
+        item = strchr(item, ',');
+        if (item != NULL)
+        {
+            item++;
+        }
+    }
+    return false;
+}
+
+UploadEngine::Result UploadEngine::fail(Result result)
+{
+    _result = result;
+    return result;
+}
+
+UploadEngine::Result UploadEngine::receive(Client &client, AnalyserRequest &request)
+{
+    _received = 0;
+    _writeFailed = false;
+    _sha256.begin();
+
+    size_t total = request.getContentLength();
+    if (total == 0)
+    {
+        return fail(LENGTH_REQUIRED);
+    }
+
+    const char *digest = request.getContentDigest();
+    _hasExpectedDigest = digest[0] != '\0';
+    if (_hasExpectedDigest && !parseDigest(digest))
+    {
+        return fail(INVALID_DIGEST);
+    }
+
+    if (!_sink.begin(total))
+    {
+        return fail(NO_SPACE);
+    }
+
+    // The client only sends the body once it knows the upload is accepted
+    if (request.expectsContinue() && request.isHttp11())
+    {
+        char interim[40];
+        int len = snprintf(interim, sizeof(interim), "HTTP/1.1 %s\r\n\r\n", StatusCode::Informational::_100_CONTINUE);
+        client.write((const uint8_t *)interim, len);
+    }
+
+    if (!startWriter())
+    {
+        _sink.abort();
+        return fail(WRITE_FAILED);
+    }
+
+    Result result = COMPLETED;
+    uint32_t lastData = millis();
+    uint32_t lastProgress = lastData;
+
+    while (_received < total && result == COMPLETED)
+    {
+        uint8_t index = nextBuffer();
+        uint8_t *buffer = _buffers[index];
+        size_t wanted = total - _received < UPLOAD_BUFFER_SIZE ? total - _received : UPLOAD_BUFFER_SIZE;
+        size_t filled = 0;
+
+        while (filled < wanted)
+        {
+            int available = client.available();
+            if (available > 0)
+            {
+                size_t n = wanted - filled < (size_t)available ? wanted - filled : (size_t)available;
+                int bytesRead = client.read(buffer + filled, n);
+                if (bytesRead > 0)
+                {
+                    filled += bytesRead;
+                    lastData = millis();
+                    continue;
+                }
+            }
+
+            if (_writeFailed)
+            {
+                result = WRITE_FAILED;
+                break;
+            }
+            if (!client.connected())
+            {
+                result = DISCONNECTED;
+                break;
+            }
+            if (millis() - lastData >= _timeoutMs)
+            {
+                result = TIMED_OUT;
+                break;
+            }
+            yield();
+        }
+
+        if (result != COMPLETED)
+        {
+            break;
+        }
+
+        // Hashed while the block is still in cache, then handed to the writer
+        _sha256.update(buffer, filled);
+        _received += filled;
+        queueBlock(index, filled);
+
+        if (_progressHandler && (_received == total || millis() - lastProgress >= _progressIntervalMs))
+        {
+            lastProgress = millis();
+            _progressHandler(_received, total);
+        }
+    }
+
+    stopWriter(); // Waits until the blocks already queued were written
+
+    _sha256.finish(_digest);
+
+    if (result == COMPLETED && _writeFailed)
+    {
+        result = WRITE_FAILED;
+    }
+    if (result == COMPLETED && _hasExpectedDigest && memcmp(_digest, _expectedDigest, sizeof(_digest)) != 0)
+    {
+        result = DIGEST_MISMATCH;
+    }
+
+    if (result != COMPLETED)
+    {
+        _sink.abort();
+        return fail(result);
+    }
+
+    if (!_sink.end())
+    {
+        return fail(END_FAILED);
+    }
+    return fail(COMPLETED);
+}
+
+void UploadEngine::respond(Client &client, AnalyserRequest &request)
+{
+    const char *code;
+    switch (_result)
+    {
+    case COMPLETED:
+        code = StatusCode::Successful::_200_OK;
+        break;
+    case LENGTH_REQUIRED:
+        code = StatusCode::ClientError::_411_LENGTH_REQUIRED;
+        break;
+    case INVALID_DIGEST:
+        code = StatusCode::ClientError::_400_BAD_REQUEST;
+        break;
+    case NO_SPACE:
+        code = StatusCode::ClientError::_413_PAYLOAD_TOO_LARGE;
+        break;
+    case TIMED_OUT:
+        code = StatusCode::ClientError::_408_REQUEST_TIMEOUT;
+        break;
+    case DIGEST_MISMATCH:
+        code = StatusCode::ClientError::_422_UNPROCESSABLE_ENTITY;
+        break;
+    case DISCONNECTED:
+        return; // Nobody to answer
+    default:
+        code = StatusCode::ServerError::_500_INTERNAL_SERVER_ERROR;
+        break;
+    }
+
+    BuildResponse response(client, request);
+    response.begin(code);
+    response.send(ContentType::TEXT_PLAIN, errorString());
+}
+
+#if defined(ESP32)
+void UploadEngine::writerTask(void *parameter)
+{
+    UploadEngine *engine = (UploadEngine *)parameter;
+
+    Block block;
+    while (xQueueReceive(engine->_filled, &block, portMAX_DELAY) == pdTRUE && block.length > 0)
+    {
+        // After a failure the remaining blocks are only recycled
+        if (!engine->_writeFailed && engine->_sink.write(engine->_buffers[block.buffer], block.length) != block.length)
+        {
+            engine->_writeFailed = true;
+        }
+        xQueueSend(engine->_free, &block.buffer, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(engine->_writerDone);
+    vTaskDelete(NULL);
+}
+
+bool UploadEngine::startWriter()
+{
+    _filled = xQueueCreate(3, sizeof(Block)); // Both buffers plus the end marker
+    _free = xQueueCreate(2, sizeof(uint8_t));
+    _writerDone = xSemaphoreCreateBinary();
+
+    if (_filled != NULL && _free != NULL && _writerDone != NULL &&
+        xTaskCreate(writerTask, "upload", UPLOAD_WRITER_STACK_SIZE, this, uxTaskPriorityGet(NULL), NULL) == pdPASS)
+    {
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            xQueueSend(_free, &i, 0);
+        }
+        return true;
+    }
+
+    if (_filled != NULL)
+    {
+        vQueueDelete(_filled);
+    }
+    if (_free != NULL)
+    {
+        vQueueDelete(_free);
+    }
+    if (_writerDone != NULL)
+    {
+        vSemaphoreDelete(_writerDone);
+    }
+    return false;
+}
+
+uint8_t UploadEngine::nextBuffer()
+{
+    uint8_t index;
+    xQueueReceive(_free, &index, portMAX_DELAY); // Waits while both buffers are being written
+    return index;
+}
+
+void UploadEngine::queueBlock(uint8_t buffer, size_t length)
+{
+    Block block = {buffer, length};
+    xQueueSend(_filled, &block, portMAX_DELAY);
+}
+
+void UploadEngine::stopWriter()
+{
+    Block end = {0, 0};
+    xQueueSend(_filled, &end, portMAX_DELAY);
+    xSemaphoreTake(_writerDone, portMAX_DELAY);
+
+    vQueueDelete(_filled);
+    vQueueDelete(_free);
+    vSemaphoreDelete(_writerDone);
+}
+#else
+bool UploadEngine::startWriter()
+{
+    _nextBuffer = 0;
+    return true;
+}
+
+uint8_t UploadEngine::nextBuffer()
+{
+    _nextBuffer ^= 1;
+    return _nextBuffer;
+}
+
+void UploadEngine::queueBlock(uint8_t buffer, size_t length)
+{
+    // No task to overlap with: the block is written right away
+    if (!_writeFailed && _sink.write(_buffers[buffer], length) != length)
+    {
+        _writeFailed = true;
+    }
+}
+
+void UploadEngine::stopWriter()
+{
+}
+#endif
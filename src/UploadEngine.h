@@ -0,0 +1,202 @@
+#ifndef UPLOAD_ENGINE_H
+#define UPLOAD_ENGINE_H
+
+#include "RequestsAndResponses.h"
+#include <atomic>
+
+#if defined(ESP32)
+#include <Update.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+/**
+ * @brief Size (in bytes) of each of the two buffers used to receive an upload.
+ *
+ * The default matches the flash sector size of the ESP32, so every block handed to the
+ * sink fills exactly one sector.
+ */
+#ifndef UPLOAD_BUFFER_SIZE
+#define UPLOAD_BUFFER_SIZE 4096
+#endif
+
+/**
+ * @brief Stack size (in bytes) of the task that writes the received blocks to the sink (ESP32 only).
+ */
+#ifndef UPLOAD_WRITER_STACK_SIZE
+#define UPLOAD_WRITER_STACK_SIZE 4096
+#endif
+
+/**
+ * @class UploadSink
+ * @brief Destination of the data received by an UploadEngine.
+ *
+ * begin() is called with the size announced by Content-Length before the body is read, and
+ * must fail when there is not enough space. write() is called with the body, in blocks of at
+ * most UPLOAD_BUFFER_SIZE bytes. Once all the data was received and verified, end() commits
+ * it; abort() discards it instead.
+ */
+class UploadSink
+{
+public:
+    virtual ~UploadSink() {}
+
+    virtual bool begin(size_t size) = 0;
+    virtual size_t write(const uint8_t *data, size_t size) = 0;
+    virtual bool end() = 0;
+    virtual void abort() = 0;
+    virtual const char *errorString() = 0;
+};
+
+#if defined(ESP32)
+/**
+ * @class UpdateSink
+ * @brief UploadSink that writes a firmware (U_FLASH) or a file system image (U_SPIFFS) with the ESP32 Update library.
+ */
+class UpdateSink : public UploadSink
+{
+public:
+    UpdateSink(int command = U_FLASH);
+
+    bool begin(size_t size) override;
+    size_t write(const uint8_t *data, size_t size) override;
+    bool end() override;
+    void abort() override;
+    const char *errorString() override;
+
+private:
+    int _command;
+};
+#endif
+
+/**
+ * @class FileSink
+ * @brief UploadSink that stores the upload in a file.
+ *
+ * Besides storing files, it can stand in for UpdateSink to exercise the upload path on
+ * any platform. An aborted upload removes the file.
+ */
+class FileSink : public UploadSink
+{
+public:
+    FileSink(fs::FS &fs, const char *path, size_t maxSize = 0);
+
+    bool begin(size_t size) override;
+    size_t write(const uint8_t *data, size_t size) override;
+    bool end() override;
+    void abort() override;
+    const char *errorString() override;
+
+private:
+    fs::FS &_fs;
+    const char *_path;
+    size_t _maxSize;
+    File _file;
+    const char *_error;
+};
+
+/**
+ * @class UploadEngine
+ * @brief Receives a request body (typically a firmware image) and streams it to an UploadSink.
+ *
+ * receive() is called once the request headers were parsed. It validates Content-Length
+ * against the space available in the sink and, when the client sent "Expect: 100-continue",
+ * answers "100 Continue" only after that, so a rejected upload is never transmitted.
+ *
+ * The body is read into two buffers of UPLOAD_BUFFER_SIZE bytes used alternately: on the
+ * ESP32 a separate task writes one buffer to the sink while the next one is being received,
+ * so network reads overlap with flash writes. On other platforms the blocks are written in
+ * sequence.
+ *
+ * The SHA-256 of the body is computed while it is received. When the request carries a
+ * Content-Digest, Repr-Digest or Digest header with a sha-256 value (Base64), or an X-SHA256
+ * header (hexadecimal), the upload is only committed if the hashes match.
+ *
+ * Progress is reported through a callback called at most once per interval, plus once when
+ * the whole body was received.
+ */
+class UploadEngine
+{
+public:
+    /**
+     * @brief Outcome of receive().
+     */
+    enum Result
+    {
+        COMPLETED,
+        LENGTH_REQUIRED,
+        INVALID_DIGEST,
+        NO_SPACE,
+        TIMED_OUT,
+        DISCONNECTED,
+        WRITE_FAILED,
+        DIGEST_MISMATCH,
+        END_FAILED
+    };
+
+    /**
+     * @brief Handler called with the number of bytes received so far and the total expected.
+     */
+    typedef std::function<void(size_t received, size_t total)> ProgressHandler;
+
+    UploadEngine(UploadSink &sink);
+
+    void onProgress(ProgressHandler handler, uint32_t intervalMs = 500);
+    void setTimeout(uint32_t timeoutMs);
+
+    Result receive(Client &client, AnalyserRequest &request);
+    void respond(Client &client, AnalyserRequest &request);
+
+    Result getResult();
+    const char *errorString();
+    size_t getReceived();
+    void getDigest(uint8_t digest[32]);
+
+private:
+    bool parseDigest(const char *value);
+    Result fail(Result result);
+
+    bool startWriter();
+    uint8_t nextBuffer();
+    void queueBlock(uint8_t buffer, size_t length);
+    void stopWriter();
+
+    UploadSink &_sink;
+    ProgressHandler _progressHandler;
+    uint32_t _progressIntervalMs;
+    uint32_t _timeoutMs;
+
+    uint8_t _buffers[2][UPLOAD_BUFFER_SIZE];
+    std::atomic<bool> _writeFailed;
+
+    Sha256 _sha256;
+    uint8_t _digest[32];
+    uint8_t _expectedDigest[32];
+    bool _hasExpectedDigest;
+
+    Result _result;
+    size_t _received;
+
+#if defined(ESP32)
+    /**
+     * @brief Buffer filled by the receiving side and waiting to be written.
+     */
+    struct Block
+    {
+        uint8_t buffer;
+        size_t length;
+    };
+
+    static void writerTask(void *parameter);
+
+    QueueHandle_t _filled;
+    QueueHandle_t _free;
+    SemaphoreHandle_t _writerDone;
+#else
+    uint8_t _nextBuffer;
+#endif
+};
+
+#endif // UPLOAD_ENGINE_H
@@ -0,0 +1,433 @@
+#include "WebSocket.h"
+#include "Digest.h"
+
+// GUID appended to the client key to compute Sec-WebSocket-Accept (RFC 6455, section 1.3)
+static const char WEBSOCKET_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// Checks if a status code may be sent in a close frame (RFC 6455, section 7.4); 1005, 1006
+// and 1015 only report a missing code or a failure locally and never appear on the wire
+static bool isValidCloseCode(uint16_t code)
+{
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1014) || (code >= 3000 && code <= 4999);
+}
+
+// Checks if a comma-separated header value contains a token (case-insensitive)
+static bool hasToken(const char *list, const char *token)
+{
+    size_t len = strlen(token);
+    const char *item = list;
+
+    while (*item != '\0')
+    {
+        while (*item == ' ' || *item == ',')
+        {
+            item++;
+        }
+
+        const char *itemEnd = item;
+        while (*itemEnd != '\0' && *itemEnd != ',' && *itemEnd != ' ')
+        {
+            itemEnd++;
+        }
+
+        if ((size_t)(itemEnd - item) == len && strncasecmp(item, token, len) == 0)
+        {
+            return true;
+        }
+        item = itemEnd;
+    }
+
+    return false;
+}
+
+WebSocket::WebSocket()
+{
+    _client = nullptr;
+    _handler = nullptr;
+    _closeSent = false;
+    _state = FRAME_HEADER;
+    _messageOpcode = 0;
+}
+
+bool WebSocket::isUpgrade(AnalyserRequest &request)
+{
+    return request.methodIs(MethodsHttp::GET) && request.isHttp11() &&
+           hasToken(request.getUpgrade(), "websocket") &&
+           hasToken(request.getConnection(), "upgrade") &&
+           strlen(request.getWebSocketKey()) == 24;
+}
+
+bool WebSocket::accept(Client &client, AnalyserRequest &request)
+{
+    if (!isUpgrade(request))
+    {
+        BuildResponse response(client);
+        response.begin(StatusCode::ClientError::_400_BAD_REQUEST);
+        response.send(ContentType::TEXT_PLAIN, "Invalid WebSocket handshake");
+        return false;
+    }
+
+    if (request.getWebSocketVersion() != 13)
+    {
+        BuildResponse response(client);
+        response.begin(StatusCode::ClientError::_426_UPGRADE_REQUIRED);
+        response.addHeader("Sec-WebSocket-Version", "13");
+        response.send();
+        return false;
+    }
+
+    // Sec-WebSocket-Accept = base64(SHA-1(key + GUID))
+    uint8_t digest[20];
+    Sha1 sha1;
+    sha1.update((const uint8_t *)request.getWebSocketKey(), strlen(request.getWebSocketKey()));
+    sha1.update((const uint8_t *)WEBSOCKET_GUID, sizeof(WEBSOCKET_GUID) - 1);
+    sha1.finish(digest);
+
+    char acceptKey[32];
+    base64Encode(digest, sizeof(digest), acceptKey, sizeof(acceptKey));
+
+    BuildResponse response(client);
+    response.begin(StatusCode::Informational::_101_SWITCHING_PROTOCOLS);
+    response.addHeader("Upgrade", "websocket");
+    response.addHeader("Connection", "Upgrade");
+    response.addHeader("Sec-WebSocket-Accept", acceptKey);
+    response.openStream();
+
+    _client = &client;
+    _closeSent = false;
+    _state = FRAME_HEADER;
+    _messageOpcode = 0;
+    return true;
+}
+
+void WebSocket::onMessage(MessageHandler handler)
+{
+    _handler = handler;
+}
+
+bool WebSocket::connected()
+{
+    return _client != nullptr && _client->connected();
+}
+
+bool WebSocket::loop()
+{
+    if (!connected())
+    {
+        return false;
+    }
+
+    int available;
+    while (_client != nullptr && (available = _client->available()) > 0)
+    {
+        size_t n = (size_t)available < sizeof(_buffer) ? available : sizeof(_buffer);
+        int bytesRead = _client->read(_buffer, n);
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+        parse(_buffer, bytesRead);
+    }
+
+    return connected();
+}
+
+void WebSocket::parse(uint8_t *data, size_t size)
+{
+    size_t i = 0;
+    while (i < size && _client != nullptr)
+    {
+        if (_state == FRAME_PAYLOAD)
+        {
+            uint64_t remaining = _payloadLength - _payloadOffset;
+            size_t n = remaining < size - i ? remaining : size - i;
+            payload(data + i, n);
+            i += n;
+            continue;
+        }
+
+        uint8_t b = data[i++];
+        switch (_state)
+        {
+        case FRAME_HEADER:
+            _final = (b & 0x80) != 0;
+            _opcode = b & 0x0F;
+
+            if ((b & 0x70) != 0)
+            {
+                fail(1002); // Reserved bits without a negotiated extension
+                return;
+            }
+            if (_opcode >= CLOSE)
+            {
+                if (!_final || _opcode > PONG)
+                {
+                    fail(1002); // Control frames cannot be fragmented
+                    return;
+                }
+            }
+            else if (_opcode == CONTINUATION ? _messageOpcode == 0 : (_messageOpcode != 0 || _opcode > BINARY))
+            {
+                fail(1002); // Unexpected continuation, interleaved message or reserved opcode
+                return;
+            }
+            _state = FRAME_LENGTH;
+            break;
+
+        case FRAME_LENGTH:
+            if ((b & 0x80) == 0)
+            {
+                fail(1002); // Frames from the client must be masked
+                return;
+            }
+
+            _payloadLength = b & 0x7F;
+            if (_opcode >= CLOSE && _payloadLength > sizeof(_control))
+            {
+                fail(1002);
+                return;
+            }
+
+            _headerBytes = 0;
+            if (_payloadLength >= 126)
+            {
+                _headerBytes = _payloadLength == 126 ? 2 : 8;
+                _payloadLength = 0;
+                _state = FRAME_EXTENDED_LENGTH;
+            }
+            else
+            {
+                _state = FRAME_MASK;
+            }
+            break;
+
+        case FRAME_EXTENDED_LENGTH:
+            if (_headerBytes == 8 && (b & 0x80) != 0)
+            {
+                fail(1002); // The most significant bit of a 64-bit length must be 0
+                return;
+            }
+            _payloadLength = (_payloadLength << 8) | b;
+            if (--_headerBytes == 0)
+            {
+                _state = FRAME_MASK;
+            }
+            break;
+
+        case FRAME_MASK:
+            _mask[_headerBytes++] = b;
+            if (_headerBytes == sizeof(_mask))
+            {
+                startPayload();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+void WebSocket::startPayload()
+{
+    _payloadOffset = 0;
+    if (_opcode == TEXT || _opcode == BINARY)
+    {
+        _messageOpcode = _opcode;
+    }
+
+    _state = FRAME_PAYLOAD;
+    if (_payloadLength == 0)
+    {
+        payload(_buffer, 0); // Empty frame: complete right away
+    }
+}
+
+void WebSocket::payload(uint8_t *data, size_t size)
+{
+    unmask(data, size);
+
+    if (_opcode >= CLOSE)
+    {
+        // Control payloads are small (up to 125 bytes) and handled once complete
+        memcpy(_control + _payloadOffset, data, size);
+        _payloadOffset += size;
+        if (_payloadOffset == _payloadLength)
+        {
+            _state = FRAME_HEADER;
+            handleControl();
+        }
+        return;
+    }
+
+    _payloadOffset += size;
+    bool frameDone = _payloadOffset == _payloadLength;
+    bool final = frameDone && _final;
+
+    if (_handler && (size > 0 || final))
+    {
+        _handler(*this, _messageOpcode, data, size, final);
+    }
+
+    if (frameDone)
+    {
+        _state = FRAME_HEADER;
+        if (_final)
+        {
+            _messageOpcode = 0;
+        }
+    }
+}
+
+void WebSocket::unmask(uint8_t *data, size_t size)
+{
+    // Mask rotated so that mask[0] applies to data[0]
+    uint8_t mask[4];
+    for (uint8_t k = 0; k < 4; k++)
+    {
+        mask[k] = _mask[(_payloadOffset + k) & 3];
+    }
+
+    // Bytes before the first word boundary
+    size_t i = 0;
+    while (i < size && ((uintptr_t)(data + i) & 3) != 0)
+    {
+        data[i] ^= mask[i & 3];
+        i++;
+    }
+
+    // Whole words
+    uint8_t wordMask[4];
+    for (uint8_t k = 0; k < 4; k++)
+    {
+        wordMask[k] = mask[(i + k) & 3];
+    }
+    uint32_t maskWord;
+    memcpy(&maskWord, wordMask, sizeof(maskWord));
+
+    for (; i + 4 <= size; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, data + i, sizeof(word));
+        word ^= maskWord;
+        memcpy(data + i, &word, sizeof(word));
+    }
+
+    // Remaining bytes
+    for (; i < size; i++)
+    {
+        data[i] ^= mask[i & 3];
+    }
+}
+
+void WebSocket::handleControl()
+{
+    size_t size = _payloadLength;
+
+    if (_opcode == PING)
+    {
+        send(PONG, _control, size);
+    }
+    else if (_opcode == PONG)
+    {
+        if (_handler)
+        {
+            _handler(*this, PONG, _control, size, true);
+        }
+    }
+    else if (_opcode == CLOSE)
+    {
+        if (_handler)
+        {
+            _handler(*this, CLOSE, _control, size, true);
+        }
+
+        // Echo the status code of the client, then close the connection; a payload of a single
+        // byte or a code that cannot be sent is a protocol error
+        uint16_t code = size >= 2 ? (_control[0] << 8) | _control[1] : 1000;
+        close(size == 1 || !isValidCloseCode(code) ? 1002 : code);
+    }
+}
+
+void WebSocket::fail(uint16_t code)
+{
+    close(code);
+}
+
+bool WebSocket::send(uint8_t opcode, const uint8_t *data, size_t size, bool final)
+{
+    if (!connected() || _closeSent)
+    {
+        return false;
+    }
+
+    // Frames sent by the server are not masked
+    uint8_t header[10];
+    size_t headerLength = 2;
+    header[0] = (final ? 0x80 : 0x00) | (opcode & 0x0F);
+    if (size < 126)
+    {
+        header[1] = size;
+    }
+    else if (size <= 0xFFFF)
+    {
+        header[1] = 126;
+        header[2] = size >> 8;
+        header[3] = size;
+        headerLength = 4;
+    }
+    else
+    {
+        header[1] = 127;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            header[2 + i] = (uint64_t)size >> (56 - 8 * i);
+        }
+        headerLength = 10;
+    }
+
+    if (_client->write(header, headerLength) != headerLength)
+    {
+        return false;
+    }
+    return size == 0 || _client->write(data, size) == size;
+}
+
+bool WebSocket::sendText(const char *text)
+{
+    return send(TEXT, (const uint8_t *)text, strlen(text));
+}
+
+bool WebSocket::sendBinary(const uint8_t *data, size_t size)
+{
+    return send(BINARY, data, size);
+}
+
+bool WebSocket::ping(const uint8_t *data, size_t size)
+{
+    return send(PING, data, size > sizeof(_control) ? sizeof(_control) : size);
+}
+
+void WebSocket::close(uint16_t code)
+{
+    if (_client == nullptr)
+    {
+        return;
+    }
+
+    if (!_closeSent)
+    {
+        if (!isValidCloseCode(code))
+        {
+            code = 1000;
+        }
+        uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+        send(CLOSE, payload, sizeof(payload));
+        _closeSent = true;
+    }
+
+    _client->stop();
+    _client = nullptr;
+    _state = FRAME_HEADER;
+    _messageOpcode = 0;
+}
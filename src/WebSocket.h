@@ -0,0 +1,108 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include "RequestsAndResponses.h"
+
+/**
+ * @brief Size (in bytes) of the buffer used to read frames from the client.
+ *
+ * Payloads are delivered to the message handler in pieces of at most this size.
+ */
+#ifndef WEBSOCKET_BUFFER_SIZE
+#define WEBSOCKET_BUFFER_SIZE 256
+#endif
+
+/**
+ * @class WebSocket
+ * @brief Server side of a WebSocket connection (RFC 6455).
+ *
+ * The connection starts as a regular request parsed by AnalyserRequest. When the request
+ * asks for an upgrade, accept() validates the handshake and answers "101 Switching Protocols";
+ * from then on, loop() must be called regularly to read the frames sent by the client.
+ *
+ * Frames are parsed incrementally, so fragmented messages and frames split across several
+ * reads are supported without buffering whole messages: the payload is unmasked in place,
+ * a word at a time, and handed to the message handler in pieces. Pings are answered
+ * automatically and a close frame is echoed before the connection is closed; a close code
+ * that must not be sent (such as 1005 or 1006) is answered with 1002, and close() sends 1000
+ * instead of such a code.
+ *
+ * Frames sent by the server are written straight from the caller's buffer, without copies.
+ */
+class WebSocket
+{
+public:
+    /**
+     * @brief Frame opcodes defined by RFC 6455.
+     */
+    enum Opcode
+    {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+    };
+
+    /**
+     * @brief Handler called with each piece of a received message.
+     *
+     * `opcode` is the opcode of the message (TEXT or BINARY, also for continuation frames),
+     * or PONG/CLOSE for control frames. `final` is true for the last piece of the message.
+     */
+    typedef std::function<void(WebSocket &socket, uint8_t opcode, const uint8_t *data, size_t size, bool final)> MessageHandler;
+
+    WebSocket();
+
+    static bool isUpgrade(AnalyserRequest &request);
+    bool accept(Client &client, AnalyserRequest &request);
+    void onMessage(MessageHandler handler);
+
+    bool loop();
+    bool connected();
+
+    bool send(uint8_t opcode, const uint8_t *data, size_t size, bool final = true);
+    bool sendText(const char *text);
+    bool sendBinary(const uint8_t *data, size_t size);
+    bool ping(const uint8_t *data = nullptr, size_t size = 0);
+    void close(uint16_t code = 1000);
+
+private:
+    /**
+     * @brief States of the frame parser.
+     */
+    enum ParserState
+    {
+        FRAME_HEADER,
+        FRAME_LENGTH,
+        FRAME_EXTENDED_LENGTH,
+        FRAME_MASK,
+        FRAME_PAYLOAD
+    };
+
+    void parse(uint8_t *data, size_t size);
+    void startPayload();
+    void payload(uint8_t *data, size_t size);
+    void unmask(uint8_t *data, size_t size);
+    void handleControl();
+    void fail(uint16_t code);
+
+    Client *_client;
+    MessageHandler _handler;
+    bool _closeSent;
+
+    ParserState _state;
+    uint8_t _headerBytes;
+    bool _final;
+    uint8_t _opcode;
+    uint8_t _messageOpcode;
+    uint64_t _payloadLength;
+    uint64_t _payloadOffset;
+    uint8_t _mask[4];
+
+    uint8_t _control[125];
+    uint8_t _buffer[WEBSOCKET_BUFFER_SIZE];
+};
+
+#endif // WEBSOCKET_H